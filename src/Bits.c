@@ -0,0 +1,255 @@
+/**  *****************************************************  **/
+/**       ** Finding the Most Representative Graph **       **/
+/**       **    Model for Neuronal Interactions    **       **/
+/**       **     via Markov Chain Monte Carlo      **       **/
+/**                                                         **/
+/**   Author: Pedro Brandimarte Mendonca                    **/
+/**                                                         **/
+/**  *****************************************************  **/
+/**  Implementation of population counts of bitsets. The    **/
+/**  portable version counts the bits of each word with the **/
+/**  "divide and conquer" method (sums of pairs, nibbles    **/
+/**  and bytes of bits). On x86 processors (and with gcc or **/
+/**  compatible compilers) there are also versions compiled **/
+/**  for the POPCNT instruction, for AVX2 (where the bits   **/
+/**  of each nibble are counted by a table lookup with      **/
+/**  VPSHUFB and the bytes are summed with VPSADBW, as      **/
+/**  proposed by W. Mula) and for AVX-512 (with the         **/
+/**  VPOPCNTQ instruction). The version is chosen at run    **/
+/**  time, so the program runs on any processor.            **/
+/**  *****************************************************  **/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include "Bits.h"
+
+#if defined(__GNUC__) && defined(__x86_64__)
+#define BITSx86 /* there are versions for x86 processors */
+#include <immintrin.h>
+#endif
+
+/* Version of the population count in use (see 'BITSinit'). */
+static unsigned long popGeneric (const unsigned long *,
+				 const unsigned long *, int, int);
+static unsigned long (*pop) (const unsigned long *, const unsigned long *,
+			     int, int) = popGeneric;
+
+
+/* ********************************************************* */
+/* Returns the number of bits equal to '1' of the word 'w'.  */
+/* The bits are summed in pairs, then in nibbles and in      */
+/* bytes, and the bytes are summed by the multiplication     */
+/* (it works for words with up to 64 bits).                  */
+static unsigned long popWord (unsigned long w)
+{
+   unsigned long m1, m2, m4, h01;
+
+   /* Masks 0x5555..., 0x3333..., 0x0f0f... and 0x0101... */
+   m1 = ~0UL / 3;
+   m2 = ~0UL / 5;
+   m4 = ~0UL / 17;
+   h01 = ~0UL / 255;
+
+   w -= (w >> 1) & m1;
+   w = (w & m2) + ((w >> 2) & m2);
+   w = (w + (w >> 4)) & m4;
+
+   return (w * h01) >> (BITSword - 8);
+
+} /* popWord */
+
+
+/* ********************************************************* */
+/* Portable version of 'BITSpop'.                            */
+static unsigned long popGeneric (const unsigned long *a,
+				 const unsigned long *b, int n, int op)
+{
+   int i;
+   unsigned long cnt = 0;
+
+   switch (op) {
+   case BITSand:
+      for (i = 0; i < n; i++)
+	 cnt += popWord (a[i] & b[i]);
+      break;
+   case BITSxor:
+      for (i = 0; i < n; i++)
+	 cnt += popWord (a[i] ^ b[i]);
+      break;
+   default:
+      for (i = 0; i < n; i++)
+	 cnt += popWord (a[i]);
+   }
+
+   return cnt;
+
+} /* popGeneric */
+
+
+#ifdef BITSx86
+
+/* ********************************************************* */
+/* Version of 'BITSpop' with the POPCNT instruction.         */
+__attribute__ ((target ("popcnt")))
+static unsigned long popPopcnt (const unsigned long *a,
+				const unsigned long *b, int n, int op)
+{
+   int i;
+   unsigned long cnt = 0;
+
+   switch (op) {
+   case BITSand:
+      for (i = 0; i < n; i++)
+	 cnt += __builtin_popcountl (a[i] & b[i]);
+      break;
+   case BITSxor:
+      for (i = 0; i < n; i++)
+	 cnt += __builtin_popcountl (a[i] ^ b[i]);
+      break;
+   default:
+      for (i = 0; i < n; i++)
+	 cnt += __builtin_popcountl (a[i]);
+   }
+
+   return cnt;
+
+} /* popPopcnt */
+
+
+/* ********************************************************* */
+/* Returns, at each 64-bit lane, the number of bits equal to */
+/* '1' of the lane of 'v': the bits of each nibble are       */
+/* counted by a lookup at the table 'lut' (VPSHUFB) and the  */
+/* 8 bytes of each lane are summed by VPSADBW.               */
+__attribute__ ((target ("avx2")))
+static __m256i count256 (__m256i v)
+{
+   __m256i lut, low, lo, hi;
+
+   lut = _mm256_setr_epi8 (0, 1, 1, 2, 1, 2, 2, 3, 1, 2, 2, 3, 2, 3, 3, 4,
+			   0, 1, 1, 2, 1, 2, 2, 3, 1, 2, 2, 3, 2, 3, 3, 4);
+   low = _mm256_set1_epi8 (0x0f);
+   lo = _mm256_shuffle_epi8 (lut, _mm256_and_si256 (v, low));
+   hi = _mm256_shuffle_epi8 (lut,
+			     _mm256_and_si256 (_mm256_srli_epi16 (v, 4), low));
+
+   return _mm256_sad_epu8 (_mm256_add_epi8 (lo, hi), _mm256_setzero_si256 ());
+
+} /* count256 */
+
+
+/* ********************************************************* */
+/* Version of 'BITSpop' with AVX2 vectors (4 words at a      */
+/* time, the remaining words are counted with POPCNT).       */
+__attribute__ ((target ("avx2,popcnt")))
+static unsigned long popAVX2 (const unsigned long *a,
+			      const unsigned long *b, int n, int op)
+{
+   int i;
+   __m256i acc, x, y;
+   unsigned long cnt;
+
+   acc = _mm256_setzero_si256 ();
+   for (i = 0; i + 4 <= n; i += 4) {
+      x = _mm256_loadu_si256 ((const __m256i *) (a + i));
+      if (op != BITSone) {
+	 y = _mm256_loadu_si256 ((const __m256i *) (b + i));
+	 x = (op == BITSand) ? _mm256_and_si256 (x, y) : _mm256_xor_si256 (x, y);
+      }
+      acc = _mm256_add_epi64 (acc, count256 (x));
+   }
+   cnt = _mm256_extract_epi64 (acc, 0) + _mm256_extract_epi64 (acc, 1)
+      + _mm256_extract_epi64 (acc, 2) + _mm256_extract_epi64 (acc, 3);
+
+   return cnt + popPopcnt (a + i, b + i, n - i, op);
+
+} /* popAVX2 */
+
+
+/* ********************************************************* */
+/* Version of 'BITSpop' with AVX-512 vectors and the         */
+/* VPOPCNTQ instruction (8 words at a time, the last words   */
+/* are loaded with a mask).                                  */
+__attribute__ ((target ("avx512f,avx512vpopcntdq")))
+static unsigned long popAVX512 (const unsigned long *a,
+				const unsigned long *b, int n, int op)
+{
+   int i;
+   __mmask8 k;
+   __m512i acc, x, y;
+
+   acc = _mm512_setzero_si512 ();
+   for (i = 0; i < n; i += 8) {
+      k = (n - i >= 8) ? 0xff : (__mmask8) ((1 << (n - i)) - 1);
+      x = _mm512_maskz_loadu_epi64 (k, a + i);
+      if (op != BITSone) {
+	 y = _mm512_maskz_loadu_epi64 (k, b + i);
+	 x = (op == BITSand) ? _mm512_and_si512 (x, y) : _mm512_xor_si512 (x, y);
+      }
+      acc = _mm512_add_epi64 (acc, _mm512_popcnt_epi64 (x));
+   }
+
+   return _mm512_reduce_add_epi64 (acc);
+
+} /* popAVX512 */
+
+#endif /* BITSx86 */
+
+
+/* ********************************************************* */
+/* Chooses the version 'kernel' of the population count, if  */
+/* it is supported by the processor, or the fastest one if   */
+/* 'kernel' is BITSbest (or is not supported). Returns the   */
+/* version chosen.                                           */
+int BITSinit (int kernel)
+{
+   int best = BITSgeneric;
+
+#ifdef BITSx86
+   __builtin_cpu_init ();
+   if (__builtin_cpu_supports ("avx512f")
+       && __builtin_cpu_supports ("avx512vpopcntdq"))
+      best = BITSavx512;
+   else if (__builtin_cpu_supports ("avx2")
+	    && __builtin_cpu_supports ("popcnt"))
+      best = BITSavx2;
+   else if (__builtin_cpu_supports ("popcnt"))
+      best = BITSpopcnt;
+#endif
+
+   if (kernel == BITSbest || kernel > best)
+      kernel = best;
+
+   switch (kernel) {
+#ifdef BITSx86
+   case BITSavx512:
+      pop = popAVX512;
+      break;
+   case BITSavx2:
+      pop = popAVX2;
+      break;
+   case BITSpopcnt:
+      pop = popPopcnt;
+      break;
+#endif
+   default:
+      kernel = BITSgeneric;
+      pop = popGeneric;
+   }
+
+   return kernel;
+
+} /* BITSinit */
+
+
+/* ********************************************************* */
+/* Returns the number of bits equal to '1' of the result of  */
+/* the operation 'op' (BITSone, BITSand or BITSxor) between  */
+/* the 'n' words of 'a' and 'b' (with BITSone, 'b' is not    */
+/* used).                                                    */
+unsigned long BITSpop (const unsigned long *a, const unsigned long *b,
+		       int n, int op)
+{
+   return pop (a, b, n, op);
+
+} /* BITSpop */
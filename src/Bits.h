@@ -0,0 +1,44 @@
+/**  *****************************************************  **/
+/**       ** Finding the Most Representative Graph **       **/
+/**       **    Model for Neuronal Interactions    **       **/
+/**       **     via Markov Chain Monte Carlo      **       **/
+/**                                                         **/
+/**   Author: Pedro Brandimarte Mendonca                    **/
+/**                                                         **/
+/**  *****************************************************  **/
+/**  Interface for population counts (number of bits equal  **/
+/**  to '1') of bitsets stored as vectors of words. Besides **/
+/**  the portable version, there are versions with the      **/
+/**  POPCNT instruction and with AVX2 and AVX-512 vectors   **/
+/**  (on x86 processors), and the fastest one supported by  **/
+/**  the processor is chosen at run time by 'BITSinit'.     **/
+/**  *****************************************************  **/
+
+/* Number of bits of a word. */
+#define BITSword (8 * (int) sizeof (unsigned long))
+
+/* Number of words of a bitset with 'n' bits. */
+#define BITSwords(n) (((n) + BITSword - 1) / BITSword)
+
+/* Operations between two bitsets (see 'BITSpop'). */
+#define BITSone 0 /* only the first bitset */
+#define BITSand 1 /* a & b */
+#define BITSxor 2 /* a ^ b */
+
+/* Versions of the population count (see 'BITSinit'). */
+#define BITSbest 0 /* the fastest supported one */
+#define BITSgeneric 1 /* portable C */
+#define BITSpopcnt 2 /* POPCNT instruction */
+#define BITSavx2 3 /* AVX2 vectors */
+#define BITSavx512 4 /* AVX-512 vectors (VPOPCNTDQ) */
+
+/* Chooses the version 'kernel' (if it is supported by the */
+/* processor) or the fastest one (if 'kernel' is BITSbest) */
+/* and returns the version chosen (until it is called, the */
+/* portable version is used).                              */
+int BITSinit (int kernel);
+
+/* Returns the number of bits equal to '1' of the result of */
+/* the operation 'op' between the 'n' words of 'a' and 'b'. */
+unsigned long BITSpop (const unsigned long *a, const unsigned long *b,
+		       int n, int op);
@@ -0,0 +1,277 @@
+/**  *****************************************************  **/
+/**       ** Finding the Most Representative Graph **       **/
+/**       **    Model for Neuronal Interactions    **       **/
+/**       **     via Markov Chain Monte Carlo      **       **/
+/**                                                         **/
+/**   Author: Pedro Brandimarte Mendonca                    **/
+/**                                                         **/
+/**  *****************************************************  **/
+/**  Implementation of the convergence diagnostics. A trace **/
+/**  keeps the sums of the values (and of their squares) of **/
+/**  at most 'DIAGmax' complete blocks of 'size' steps.     **/
+/**  When all of them are filled, each pair of neighbouring **/
+/**  blocks is merged and the size of the blocks doubles.   **/
+/**  The effective sample size is estimated from the        **/
+/**  autocorrelations of the means of the blocks, summed up **/
+/**  to Geyer's initial monotone sequence (C. J. Geyer,     **/
+/**  "Practical Markov Chain Monte Carlo", Statistical      **/
+/**  Science 7, 1992), and the split-Rhat compares the      **/
+/**  first and the second halves of the blocks of each      **/
+/**  trace. The values are summed relative to the first one **/
+/**  to avoid cancellations in the variances.               **/
+/**  *****************************************************  **/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <math.h>
+#include "Utils.h"
+#include "Diag.h"
+
+#define DIAGmax 1024 /* maximum number of complete blocks */
+#define DIAGsize 1000 /* initial number of steps of a block */
+#define DIAGmin 8 /* minimum number of blocks of an estimate */
+
+struct DIAGtrace {
+   double shift; /* first value added */
+   int k; /* number of complete blocks */
+   unsigned long size; /* steps of each block */
+   unsigned long fill; /* steps of the incomplete block */
+   double s, s2; /* sums of the incomplete block */
+   double sum[DIAGmax], sum2[DIAGmax]; /* sums of the complete blocks */
+};
+
+
+/* ********************************************************* */
+/* Creates an empty trace.                                   */
+Trace DIAGinit ()
+{
+   Trace t;
+
+   t = UTILmalloc (sizeof *t);
+   t->shift = 0.0;
+   t->k = 0;
+   t->size = DIAGsize;
+   t->fill = 0;
+   t->s = t->s2 = 0.0;
+
+   return t;
+
+} /* DIAGinit */
+
+
+/* ********************************************************* */
+/* Closes the incomplete block of 't' and, if there is no    */
+/* room for another one, merges the pairs of blocks.         */
+static void closeBlock (Trace t)
+{
+   int i;
+
+   t->sum[t->k] = t->s;
+   t->sum2[t->k] = t->s2;
+   t->k++;
+   t->fill = 0;
+   t->s = t->s2 = 0.0;
+
+   if (t->k == DIAGmax) {
+      for (i = 0; i < DIAGmax / 2; i++) {
+	 t->sum[i] = t->sum[2*i] + t->sum[2*i+1];
+	 t->sum2[i] = t->sum2[2*i] + t->sum2[2*i+1];
+      }
+      t->k = DIAGmax / 2;
+      t->size *= 2;
+   }
+
+} /* closeBlock */
+
+
+/* ********************************************************* */
+/* Adds 'w' steps with the value 'x' to the trace 't',       */
+/* splitting them among the blocks.                          */
+void DIAGadd (Trace t, double x, unsigned long w)
+{
+   unsigned long n;
+
+   if (t->k == 0 && t->fill == 0)
+      t->shift = x; /* first value */
+   x -= t->shift;
+
+   while (w > 0) {
+      n = t->size - t->fill; /* room of the block */
+      if (n > w)
+	 n = w;
+      t->s += n * x;
+      t->s2 += n * x * x;
+      t->fill += n;
+      w -= n;
+      if (t->fill == t->size)
+	 closeBlock (t);
+   }
+
+} /* DIAGadd */
+
+
+/* ********************************************************* */
+/* Returns the autocovariance, at 'lag', of the means of the */
+/* 'k' blocks with sums 'sum' and 'size' steps, whose mean   */
+/* is 'mu'.                                                  */
+static double autocov (double *sum, int k, unsigned long size,
+		       double mu, int lag)
+{
+   int i;
+   double g = 0.0;
+
+   for (i = 0; i + lag < k; i++)
+      g += (sum[i] / size - mu) * (sum[i+lag] / size - mu);
+
+   return g / k;
+
+} /* autocov */
+
+
+/* ********************************************************* */
+/* Returns the effective sample size of the complete blocks  */
+/* of 't': the variance of the values divided by the         */
+/* variance of their mean, 'g0 tau / k', where 'g0' is the   */
+/* variance of the means of the 'k' blocks and 'tau' is the  */
+/* integrated autocorrelation time of the blocks.            */
+double DIAGess (Trace t)
+{
+   int j, k = t->k;
+   unsigned long n; /* steps of the complete blocks */
+   double mu, var, g0, g, prev, tau;
+
+   if (k < DIAGmin)
+      return 0.0; /* too short */
+
+   /* Mean and variance of the values. */
+   n = k * t->size;
+   mu = var = 0.0;
+   for (j = 0; j < k; j++) {
+      mu += t->sum[j];
+      var += t->sum2[j];
+   }
+   mu /= n;
+   var = var / n - mu * mu;
+
+   g0 = autocov (t->sum, k, t->size, mu, 0);
+   if (var <= 0.0 || g0 <= 0.0)
+      return (double) n; /* no fluctuation between the blocks */
+
+   /* Sums the pairs of autocovariances while they are */
+   /* positive, forcing them to be decreasing.         */
+   tau = 0.0;
+   prev = HUGE_VAL;
+   for (j = 0; 2 * j + 1 < k; j++) {
+      g = autocov (t->sum, k, t->size, mu, 2*j)
+	 + autocov (t->sum, k, t->size, mu, 2*j+1);
+      if (g <= 0.0)
+	 break;
+      if (g > prev)
+	 g = prev;
+      tau += g;
+      prev = g;
+   }
+   tau = (2.0 * tau - g0) / g0;
+   if (tau < 1.0 / k)
+      tau = 1.0 / k;
+
+   if (k * var / (g0 * tau) > n)
+      return (double) n;
+
+   return k * var / (g0 * tau);
+
+} /* DIAGess */
+
+
+/* ********************************************************* */
+/* Returns the split-Rhat of the 'm' traces 't': each trace  */
+/* gives two sequences, with its first and its last 'L'      */
+/* complete blocks, and the variance 'B/n' of the means of   */
+/* the '2m' sequences is compared with the mean 'W' of their */
+/* variances: 'Rhat = sqrt ((n-1)/n + B/(n W))'.             */
+double DIAGrhat (Trace *t, int m)
+{
+   int i, j, h, L;
+   unsigned long n; /* steps of a sequence */
+   double N, s, s2, mean, vmean, W, B;
+   double *mu; /* means of the sequences */
+
+   /* Number of blocks of each sequence. */
+   L = t[0]->k / 2;
+   for (i = 1; i < m; i++)
+      if (t[i]->k / 2 < L)
+	 L = t[i]->k / 2;
+   if (L < DIAGmin / 2)
+      return HUGE_VAL; /* too short */
+
+   mu = UTILmalloc (2 * m * sizeof (double));
+   W = N = 0.0;
+   for (i = 0; i < m; i++)
+      for (h = 0; h < 2; h++) {
+	 n = L * t[i]->size;
+	 s = s2 = 0.0;
+	 for (j = h ? t[i]->k - L : 0; j < (h ? t[i]->k : L); j++) {
+	    s += t[i]->sum[j];
+	    s2 += t[i]->sum2[j];
+	 }
+	 mu[2*i+h] = t[i]->shift + s / n;
+	 W += (s2 - s * s / n) / (n - 1);
+	 N += n;
+      }
+   W /= 2 * m;
+   N /= 2 * m;
+
+   /* Variance of the means of the sequences. */
+   mean = vmean = 0.0;
+   for (i = 0; i < 2 * m; i++)
+      mean += mu[i];
+   mean /= 2 * m;
+   for (i = 0; i < 2 * m; i++)
+      vmean += (mu[i] - mean) * (mu[i] - mean);
+   vmean /= 2 * m - 1;
+   free (mu);
+
+   if (W <= 0.0) /* the sequences do not move */
+      return (vmean > 0.0) ? HUGE_VAL : 1.0;
+   B = N * vmean;
+
+   return sqrt ((N - 1.0) / N + B / (N * W));
+
+} /* DIAGrhat */
+
+
+/* ********************************************************* */
+/* Writes the trace 't' at the binary file 'out' (it has no  */
+/* pointers, so it is written as a whole).                   */
+void DIAGwrite (FILE *out, Trace t)
+{
+   fwrite (t, sizeof *t, 1, out);
+
+} /* DIAGwrite */
+
+
+/* ********************************************************* */
+/* Reads a trace from the binary file 'in'. Returns NULL if  */
+/* it could not be read.                                     */
+Trace DIAGread (FILE *in)
+{
+   Trace t;
+
+   t = UTILmalloc (sizeof *t);
+   if (fread (t, sizeof *t, 1, in) != 1) {
+      free (t);
+      return NULL;
+   }
+
+   return t;
+
+} /* DIAGread */
+
+
+/* ********************************************************* */
+/* Frees the memory of a trace.                              */
+void DIAGfree (Trace t)
+{
+   free (t);
+
+} /* DIAGfree */
@@ -0,0 +1,45 @@
+/**  *****************************************************  **/
+/**       ** Finding the Most Representative Graph **       **/
+/**       **    Model for Neuronal Interactions    **       **/
+/**       **     via Markov Chain Monte Carlo      **       **/
+/**                                                         **/
+/**   Author: Pedro Brandimarte Mendonca                    **/
+/**                                                         **/
+/**  *****************************************************  **/
+/**  Interface for the convergence diagnostics of a scalar  **/
+/**  quantity along a Markov chain (e.g. the number of      **/
+/**  edges of the graphs). The values of the steps are      **/
+/**  added online to a 'Trace', which only keeps the sums   **/
+/**  of blocks of consecutive steps, so it takes constant   **/
+/**  memory whatever the length of the chain. From them it  **/
+/**  estimates the effective sample size of the chain and   **/
+/**  the split-Rhat of a set of chains (see A. Gelman et    **/
+/**  al., "Bayesian Data Analysis", 3rd Edition, 2013).     **/
+/**  *****************************************************  **/
+
+/* Handle of the trace of a quantity. */
+typedef struct DIAGtrace *Trace;
+
+/* Creates an empty trace. */
+Trace DIAGinit ();
+
+/* Adds 'w' steps with the value 'x' to the trace. */
+void DIAGadd (Trace, double x, unsigned long w);
+
+/* Returns the effective sample size of the trace (0 if it */
+/* is too short to be estimated).                          */
+double DIAGess (Trace);
+
+/* Returns the split-Rhat of the 'm' traces 't' (HUGE_VAL  */
+/* if they are too short to be compared).                  */
+double DIAGrhat (Trace *t, int m);
+
+/* Writes a trace at the binary file 'out'. */
+void DIAGwrite (FILE *out, Trace);
+
+/* Reads a trace from the binary file 'in' (see 'DIAGwrite'). */
+/* Returns NULL if it could not be read.                      */
+Trace DIAGread (FILE *in);
+
+/* Frees the memory of a trace. */
+void DIAGfree (Trace);
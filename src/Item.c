@@ -10,28 +10,204 @@
 /**  Parts 1-4", 3rd Edition, Addison-Wesley (1998).        **/
 /**  *****************************************************  **/
 /**  Abstract data type implementation for graph items,     **/
-/**  which are represented by strings containing '0's and   **/
-/**  '1's.                                                  **/
+/**  which are represented by sequences of bits packed      **/
+/**  into arrays of 'unsigned long' words. The first word   **/
+/**  of each item is its Zobrist hash and the bits start at **/
+/**  the second word.                                       **/
 /**  *****************************************************  **/
 
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
-#include "Item.h"
 #include "Utils.h"
+#include "Bits.h"
+#include "Item.h"
+
+
+#define ZOBseed 0x2545F4914F6CDD1DUL /* seed of the Zobrist words */
+
+/* Word that holds the element 'i' and the mask that selects   */
+/* it (elements are stored from the most significant bit).     */
+/* The word 0 holds the hash of the item.                      */
+#define word(i) (1 + (i) / BITSword)
+#define mask(i) (1UL << (BITSword - 1 - (i) % BITSword))
+
+static int Nelem; /* number of elements of an item */
+static int Nwords; /* number of words of an item (besides the hash) */
+static unsigned long *zobrist; /* random word of each element */
+
+
+/* ********************************************************* */
+/* Returns the next value of the "splitmix64" generator with */
+/* state 's' (used to draw the Zobrist words, independently  */
+/* of the generator of the Monte Carlo).                     */
+static unsigned long splitmix (unsigned long *s)
+{
+   unsigned long z;
+
+   z = (*s += 0x9E3779B97F4A7C15UL);
+   z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9UL;
+   z = (z ^ (z >> 27)) * 0x94D049BB133111EBUL;
+
+   return z ^ (z >> 31);
+
+} /* splitmix */
+
+
+/* ********************************************************* */
+/* Sets the number of elements 'n' (possible edges) of every */
+/* item, computes how many words are needed to store it and  */
+/* draws the Zobrist word of each element.                   */
+void ITEMinit (int n)
+{
+   int i;
+   unsigned long s = ZOBseed;
+
+   Nelem = n;
+   Nwords = BITSwords (n);
+
+   free (zobrist);
+   zobrist = UTILmalloc ((n + 1) * sizeof (unsigned long));
+   for (i = 0; i < n; i++)
+      zobrist[i] = splitmix (&s);
+
+} /* ITEMinit */
 
 
 /* ********************************************************* */
-/* Reads a key from standard input and copies it into 'x'.   */
-int ITEMscan (char **x)
+/* Allocates a new item with all elements set to '0' (and    */
+/* thus with hash 0). The unused bits of the last word are   */
+/* always kept as '0', so that whole words can be compared.  */
+Item ITEMnew ()
 {
-   int t;
-   char buf[1000];
+   Item x;
+
+   x = UTILmalloc ((Nwords + 1) * sizeof (unsigned long));
+   memset (x, 0, (Nwords + 1) * sizeof (unsigned long));
+
+   return x;
+
+} /* ITEMnew */
+
+
+/* ********************************************************* */
+/* Frees the memory of an item 'x'.                          */
+void ITEMfree (Item x)
+{
+   free (x);
+
+} /* ITEMfree */
+
+
+/* ********************************************************* */
+/* Returns a copy of the item 'x' whose memory is taken from */
+/* the arena 'a' (it is freed with the arena, not with       */
+/* 'ITEMfree').                                              */
+Item ITEMdup (Arena a, Item x)
+{
+   Item y;
+
+   y = UTILarenaAlloc (a, (Nwords + 1) * sizeof (unsigned long));
+   ITEMcopy (y, x);
+
+   return y;
+
+} /* ITEMdup */
+
+
+/* ********************************************************* */
+/* Copies the item 'src' into the item 'dst'.                */
+void ITEMcopy (Item dst, Item src)
+{
+   memcpy (dst, src, (Nwords + 1) * sizeof (unsigned long));
+
+} /* ITEMcopy */
+
+
+/* ********************************************************* */
+/* Compares the items 'a' and 'b' word by word, starting by  */
+/* their hashes, and returns a negative value, zero or a     */
+/* positive value if 'a' is smaller, equal or greater than   */
+/* 'b', respectively.                                        */
+int ITEMcompare (Item a, Item b)
+{
+   int i;
+
+   for (i = 0; i <= Nwords; i++)
+      if (a[i] != b[i])
+	 return (a[i] < b[i]) ? -1 : 1;
+
+   return 0;
+
+} /* ITEMcompare */
 
-   t = scanf ("%s", buf);
-   *x = UTILmalloc (size (buf) * sizeof (char));
-   (*x)[0] = '\0';
-   copy (*x, buf);
+
+/* ********************************************************* */
+/* Compares the keys of the items 'a' and 'b' word by word,  */
+/* skipping their hashes, which is the lexicographic order   */
+/* of their keys as strings of '0's and '1's (used to report */
+/* the items, see 'STsort').                                 */
+int ITEMkeyCompare (Item a, Item b)
+{
+   int i;
+
+   for (i = 1; i <= Nwords; i++)
+      if (a[i] != b[i])
+	 return (a[i] < b[i]) ? -1 : 1;
+
+   return 0;
+
+} /* ITEMkeyCompare */
+
+
+/* ********************************************************* */
+/* Returns the Zobrist hash of the item 'x' (the "exclusive  */
+/* or" of the Zobrist words of its elements equal to '1'),   */
+/* which is kept up to date by 'ITEMgenerator'.              */
+unsigned long ITEMhash (Item x)
+{
+   return x[0];
+
+} /* ITEMhash */
+
+
+/* ********************************************************* */
+/* Returns the value (0 or 1) of the element 'idx' of 'x'.   */
+int ITEMelem (Item x, int idx)
+{
+   return ((x[word(idx)] & mask(idx)) != 0);
+
+} /* ITEMelem */
+
+
+/* ********************************************************* */
+/* Returns the number of elements of 'x' equal to '1' (the   */
+/* population count of its words, see Bits.h).               */
+int ITEMcount (Item x)
+{
+   return (int) BITSpop (x + 1, NULL, Nwords, BITSone);
+
+} /* ITEMcount */
+
+
+/* ********************************************************* */
+/* Reads a key (a string of '0's and '1's) from standard     */
+/* input and packs it into a new item 'x'.                   */
+int ITEMscan (Item *x)
+{
+   int i, t;
+   char *buf, fmt[20];
+
+   buf = UTILmalloc ((Nelem + 1) * sizeof (char));
+   sprintf (fmt, "%%%ds", Nelem);
+
+   t = scanf (fmt, buf);
+   *x = ITEMnew ();
+   for (i = 0; i < Nelem && buf[i] != '\0'; i++)
+      if (buf[i] == '1')
+	 ITEMgenerator (*x, i + 1);
+
+   free (buf);
 
    return t;
 
@@ -39,73 +215,107 @@ int ITEMscan (char **x)
 
 
 /* ********************************************************* */
-/* Prints at 'std' the key of an item 'x'.                   */
-void ITEMshow (FILE *std, char *x)
+/* Prints at 'std' the key of an item 'x' as a string of     */
+/* '0's and '1's.                                            */
+void ITEMshow (FILE *std, Item x)
 {
-   fprintf (std, "%s\n", x);
+   int i;
+
+   for (i = 0; i < Nelem; i++)
+      putc (ITEMelem (x, i) ? '1' : '0', std);
+   putc ('\n', std);
 
 } /* ITEMshow */
 
 
+/* ********************************************************* */
+/* Writes the words of the elements of 'x' (not its hash) at */
+/* the binary file 'out'.                                    */
+void ITEMwrite (FILE *out, Item x)
+{
+   fwrite (x + 1, sizeof (unsigned long), Nwords, out);
+
+} /* ITEMwrite */
+
+
+/* ********************************************************* */
+/* Reads the words of the elements of 'x' from the binary    */
+/* file 'in' and computes its hash. Returns 1 on success or  */
+/* 0 if the words could not be read.                         */
+int ITEMread (FILE *in, Item x)
+{
+   int i;
+
+   if (fread (x + 1, sizeof (unsigned long), Nwords, in) != (size_t) Nwords)
+      return 0;
+   x[0] = 0;
+   for (i = 0; i < Nelem; i++)
+      if (x[word(i)] & mask(i))
+	 x[0] ^= zobrist[i];
+
+   return 1;
+
+} /* ITEMread */
+
+
 /* ********************************************************* */
 /* Performs the unary operator "not" (logical negation) on   */
 /* an element index '|idx|-1' from an item 'new'.            */
-/* If 'idx > 0' indicates that the element 'new[idx-1]' is   */
-/* '0' and then changes it to '1'. If 'idx < 0' indicates    */
-/* that the element 'new[-idx-1]' is '1' and then changes it */
-/* to '0'.                                                   */
-void ITEMgenerator (char *new, int idx)
+/* If 'idx > 0' indicates that the element 'idx-1' is '0'    */
+/* and then changes it to '1'. If 'idx < 0' indicates that   */
+/* the element '-idx-1' is '1' and then changes it to '0'.   */
+/* In both cases the hash is updated with an "exclusive or"  */
+/* of the Zobrist word of the element.                       */
+void ITEMgenerator (Item new, int idx)
 {
-   if (idx > 0)
-      new[idx-1] = '1';
-   else
-      new[-idx-1] = '0';
+   if (idx > 0) {
+      new[word(idx-1)] |= mask(idx-1);
+      new[0] ^= zobrist[idx-1];
+   }
+   else {
+      new[word(-idx-1)] &= ~mask(-idx-1);
+      new[0] ^= zobrist[-idx-1];
+   }
 
 } /* ITEMgenerator */
 
 
 /* ********************************************************* */
-/* Generates a pseudo-random index. Receives the length      */
-/* 'delta' of a partition, generates a pseudo-random number  */
-/* 'u' uniformly distributed in [0,1] and checks to which    */
-/* partition 'part' this 'u' belongs (that's the index).     */
-static int geraIdx (double delta)
+/* Assigns at once the 'BITSword' elements of the word 'w'   */
+/* of 'x' to the word 'bits', in the layout of the items     */
+/* (the element 'BITSword w + j' is the bit 'BITSword-1-j'), */
+/* whose bits beyond the last element must be '0'. The hash  */
+/* is updated with the Zobrist words of the elements that    */
+/* change, which are returned (in the same layout).          */
+unsigned long ITEMassign (Item x, int w, unsigned long bits)
 {
-   int part;
-   double u;
-   
-   /* Generates u ~ Unif[0,1]. */
-   u = 1.0 * rand() / RAND_MAX;
+   int j;
+   unsigned long d, r;
 
-   /* Checks where is 'u'. */
-   for (part = 1; delta * part < 1.0; part++)
-      if (u < delta * part)
-	 return (part - 1);
-   return (part - 1);
+   d = bits ^ x[1 + w]; /* changed elements */
+   x[1 + w] = bits;
+   for (j = 0, r = d; r != 0; j++, r <<= 1)
+      if (r & mask (0))
+	 x[0] ^= zobrist[w * BITSword + j];
 
-} /* geraIdx */
+   return d;
+
+} /* ITEMassign */
 
 
 /* ********************************************************* */
 /* Picks a random element from an item and returns its index */
 /* plus 1 ('idx + 1') if the element is '0' or the negative  */
 /* value 'idx - 1'. The addition (or subtraction) of '1' is  */
-/* necessary to avoid mistake when the index is zero.        */
-int ITEMrandIdx (char *item)
+/* necessary to avoid mistake when the index is zero. The    */
+/* index 'idx' is drawn by the caller uniformly in           */
+/* [0,Nelem-1] (each chain has its own generator, whose      */
+/* bounded draws take constant time, see Rng.h).             */
+int ITEMrandIdx (Item item, int idx)
 {
-   int idx;
-   double delta;
-
-   /* Computes the length of a partition of [0,1]. */
-   delta = 1.0 / size(item);
-
-   /* Generates a pseudo-random index. */
-   idx = geraIdx (delta);
-
-   if (item[idx] == '0')
+   if (!ITEMelem (item, idx))
       return (idx + 1);
 
    return (-idx - 1);
 
 } /* ITEMrandIdx */
-
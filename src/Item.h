@@ -10,9 +10,11 @@
 /**  Parts 1-4", 3rd Edition, Addison-Wesley (1998).        **/
 /**  *****************************************************  **/
 /**  Abstract data type interface for graph items, which    **/
-/**  are represented by strings containing '0's and '1's.   **/
-/**  Therefore, the associated operations for an item are   **/
-/**  those for strings and a few others.                    **/
+/**  are represented by sequences of bits packed into       **/
+/**  arrays of machine words (one bit for each possible     **/
+/**  edge). Therefore, the associated operations for an     **/
+/**  item are comparisons, copies and hashes performed a    **/
+/**  whole word at a time and a few others.                 **/
 /**  One of the most common representations for a graphs    **/
 /**  is the adjacent matrix, i.e., a square matrix where    **/
 /**  an element 'a_ij = 1' indicates that there is an edge  **/
@@ -22,34 +24,90 @@
 /**  graphs, the adjacent matrix is symmetric and it is     **/
 /**  necessary only to know the elements above (or below)   **/
 /**  the main diagonal. Thus, these items (undirected       **/
-/**  graphs) are strings that represents the elements       **/
-/**  above the main diagonal. The way of indexing a string  **/
+/**  graphs) are bit vectors that represents the elements   **/
+/**  above the main diagonal. The way of indexing a vector  **/
 /**  V to match the adjacent matrix AM is given by:         **/
 /**     for a_ij in AM:  if i < j,  V[i+1+(j+1)*(j-2)/2]    **/
 /**                      otherwise, V[j+1+(i+1)*(i-2)/2]    **/
+/**  Each item also carries a Zobrist hash of its bits: a   **/
+/**  random word is drawn for each element and the hash is  **/
+/**  the "exclusive or" of the words of the elements equal  **/
+/**  to '1'. Thus, changing one element ('ITEMgenerator')   **/
+/**  updates the hash with a single "exclusive or" and      **/
+/**  'ITEMhash' is O(1). The hash is also the primary key   **/
+/**  of the comparisons: items are ordered by their hashes  **/
+/**  and the bits are only compared when the hashes are     **/
+/**  equal (which, for distinct items, is very unlikely).   **/
+/**  This order is not meaningful, so the items are         **/
+/**  reported in the lexicographic order of their keys      **/
+/**  (see 'ITEMkeyCompare').                                **/
 /**  *****************************************************  **/
 
-typedef char *Item;
-typedef char *Key;
+typedef unsigned long *Item;
+typedef unsigned long *Key;
 
 #define key(A) (A)
-#define eq(A, B) (strcmp(A,B)==0)
-#define less(A, B) (strcmp(A,B)<0)
-#define size(A) (strlen(A))
-#define copy(A, B) (strcpy(A,B))
-#define comp(A, B) (strcmp(A,B))
+#define eq(A, B) (ITEMcompare(A,B)==0)
+#define less(A, B) (ITEMcompare(A,B)<0)
+#define copy(A, B) (ITEMcopy(A,B))
+#define comp(A, B) (ITEMcompare(A,B))
 #define NULLitem (NULL)
 #define idxAdj(i, j) (((i)<(j)) ? (i+1+(j+1)*(j-2)/2) : (j+1+(i+1)*(i-2)/2))
 
+/* Sets the number of elements (possible edges) of every */
+/* item. Must be called before any other operation.      */
+void ITEMinit (int n);
+
+/* Allocates a new item with all elements set to '0'. */
+Item ITEMnew ();
+
+/* Frees the memory of an item. */
+void ITEMfree (Item);
+
+/* Returns a copy of an item taken from an arena (see Utils.h). */
+Item ITEMdup (Arena, Item);
+
+/* Copies the second item into the first one. */
+void ITEMcopy (Item, Item);
+
+/* Compares two items (returns <0, 0 or >0 like 'strcmp'). */
+int ITEMcompare (Item, Item);
+
+/* Compares the keys of two items, without their hashes. */
+int ITEMkeyCompare (Item, Item);
+
+/* Returns the (Zobrist) hash value of the key of an item. */
+unsigned long ITEMhash (Item);
+
+/* Returns the value (0 or 1) of the 'idx' element. */
+int ITEMelem (Item, int idx);
+
+/* Returns the number of elements of an item equal to '1'. */
+int ITEMcount (Item x);
+
 /* Reads a key from standard input. */
 int ITEMscan (Item *);
 
 /* Prints at 'std' the key of an item. */
 void ITEMshow (FILE *std, Item);
 
+/* Writes the elements of an item at the binary file 'out'. */
+void ITEMwrite (FILE *out, Item);
+
+/* Reads the elements of an item from the binary file 'in'  */
+/* (see 'ITEMwrite'). Returns 1 on success or 0 if not.     */
+int ITEMread (FILE *in, Item);
+
 /* Changes the 'idx' element from an item. */
-void ITEMgenerator (char *new, int idx);
+void ITEMgenerator (Item new, int idx);
+
+/* Assigns the elements of the word 'w' of an item (the      */
+/* element 'BITSword w + j' is the bit 'BITSword-1-j' of      */
+/* 'bits') and returns the elements that changed (in the same */
+/* layout).                                                   */
+unsigned long ITEMassign (Item, int w, unsigned long bits);
 
-/* Picks a random element from an item and returns its index */
-/* if the element is '0' or the negative value of the index. */
-int ITEMrandIdx (char *item);
+/* Picks the element 'idx' (drawn uniformly by the caller) of */
+/* an item and returns its index if the element is '0' or the */
+/* negative value of the index.                               */
+int ITEMrandIdx (Item item, int idx);
@@ -13,34 +13,234 @@
 /**  given by the posterior probability 'P(g|X)'. This is   **/
 /**  done via Monte Carlo method with Metropolis            **/
 /**  algorithm.                                             **/
-/**  The generated graphs are stored in a skip list         **/
-/**  symbol-table whose nodes have a counter that is        **/
-/**  incremented each time an item of an existing node is   **/
-/**  searched (to avoid the need to store each generated    **/
-/**  graph, i.e., only distinct graphs are stored). The     **/
-/**  use of skip list structure has also the advantage      **/
-/**  that search, insertion and removal are O(log N).       **/
+/**  The generated graphs are stored in a symbol-table      **/
+/**  whose nodes have a counter that is incremented each    **/
+/**  time an item of an existing node is searched (to avoid **/
+/**  the need to store each generated graph, i.e., only     **/
+/**  distinct graphs are stored). The symbol-table is       **/
+/**  either a skip list, whose search, insertion and        **/
+/**  removal are O(log N), or a hash table, whose search    **/
+/**  and insertion take constant expected time.             **/
 /**  *****************************************************  **/
 
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
 #include <math.h>
+#include <pthread.h>
+#include <time.h>
+#include <unistd.h>
+#include <sys/types.h>
+#include <sys/stat.h>
+#include <sys/wait.h>
 #include "Utils.h"
+#include "Bits.h"
+#include "Rng.h"
+#include "Diag.h"
 #include "Item.h"
 #include "ST.h"
+#include "Pool.h"
 #include "Neuro.h"
 
 #define Trange 0.01 /* time range = 0.01 s = 10 ms */
 #define Tstep 100 /* consider 1 Trange window after Tstep=100*Trange */
 #define Jij 1.0 /* interaction "energy" */
 #define Nsteps 100000 /* # Monte Carlo steps */
+#define Nblock 512 /* words of the blocks of spikes scanned at a time */
+#define Nswap 1000 /* # MC steps between replica exchanges */
+#define CACHEline 64 /* bytes of a cache line */
+
+/* Sampling kernels. */
+#define KERNELmetropolis 0 /* one random edge per step */
+#define KERNELgibbs 1 /* systematic scan of all edges per step */
+
+/* Penalty sweeps. */
+#define SWEEPgrid 0 /* independent runs */
+#define SWEEPpt 1 /* replica exchange (parallel tempering) */
+#define SWEEPreweight 2 /* histogram reweighting from anchors */
+#define SWEEPwarm 3 /* each run starts from the previous one */
+#define WARMsweeps 10 /* steps per edge of a block of the warm burn-in */
+#define WARMbatches 10 /* batches of a block (for its standard error) */
+#define WARMmin 3 /* least number of blocks of the warm burn-in */
+#define WARMz 2.0 /* standard errors of a change without drift */
+#define SWEEPadaptive 4 /* coarse points refined where the results change */
+#define WHAMiter 100000 /* maximum iterations of the reweighting */
+#define WHAMtol 1e-9 /* relative tolerance of the reweighting */
+#define WHAMoverlap 0.05 /* least overlap of neighbouring anchors */
 
 /* Structure to store the considered spikes read from the    */
-/* data file, where 'label' is the neuron label and 'spikes' */
-/* is a vector of spikes in the time interval considered.    */
+/* data file, where 'label' is the neuron label, 'path' is   */
+/* the path to its spikes data and 'spikes' is a bitset (see */
+/* Bits.h) with the spikes in the time interval considered.  */
 typedef struct NEUROspk spkInfo;
-struct  NEUROspk { char label[5]; int *spikes; };
+struct  NEUROspk { char label[5]; char path[150]; unsigned long *spikes; };
+
+/* The binned spikes of a set of neurons are kept in a cache  */
+/* file (see 'spkLoad'), which starts with a header, followed */
+/* by the description of each neuron (with the size and the  */
+/* modification time of its spike file, so that the cache is  */
+/* rebuilt when they change) and, from 'cacheOffset', by the  */
+/* bitsets of the spikes of each neuron. The cache is only    */
+/* valid in machines with the same word size and layout of    */
+/* the structures (it is rebuilt otherwise).                  */
+#define CACHEmagic 0x4E535043UL /* "NSPC" */
+#define CACHEversion 1
+#define cacheOffset(n) ((long) ((sizeof (cacheHeader) + (n) * sizeof (cacheNeuron) \
+  + sizeof (unsigned long) - 1) / sizeof (unsigned long) * sizeof (unsigned long)))
+typedef struct {
+   unsigned long magic;
+   int version, wordSize; /* version and 'sizeof (unsigned long)' */
+   int mouse, part, Nneuron, spkRange;
+   char region[6];
+   double range, step, min; /* 'Trange', 'Tstep' and minimum time */
+} cacheHeader;
+typedef struct { char label[5]; char path[150]; long size, mtime; } cacheNeuron;
+
+/* Cache mapped into memory ('buf' is NULL if the spikes were */
+/* read from the spike files).                                */
+typedef struct { char *buf; long size; } cacheInfo;
+
+/* The chains of 'bestGraph' can be saved at a checkpoint     */
+/* file (see 'ckptWrite'), which starts with a header that    */
+/* identifies the run, with the number 'round' of rounds of   */
+/* the chains already computed (see 'mcChains'). For each     */
+/* chain, it follows its generator and counters, its current  */
+/* graph, its traces (see Diag.h), its counters of the        */
+/* marginal probabilities (if computed) and the 'Nitems'      */
+/* graphs of its histogram, each one after its counter.       */
+#define CKPTmagic 0x4E434B50UL /* "NCKP" */
+#define CKPTversion 2
+typedef struct {
+   unsigned long magic;
+   int version, wordSize; /* version and 'sizeof (unsigned long)' */
+   int mouse, part, met, Nedges, Nchains, stKind, topK, marginals, kernel;
+   char region[6];
+   double penal;
+   unsigned long seed, maxMCsteps, round;
+} ckptHeader;
+typedef struct {
+   Rng rng;
+   unsigned long steps, accept, clock, Nitems;
+} ckptChain;
+
+/* Sufficient statistics of the spikes of all neurons: the   */
+/* number 'count[i]' of windows with spikes of neuron 'i'    */
+/* and the number 'n11[g]' of windows with spikes of both    */
+/* neurons of the edge 'g' (with the index rule of the       */
+/* graphs, see 'gibbsEn'). Any method of computing the       */
+/* "interaction energies" only depends on these numbers.     */
+typedef struct NEUROstats statsInfo;
+struct NEUROstats { long *count; long *n11; };
+
+/* State of a Markov chain: its own symbol-table 'st' of the  */
+/* generated graphs, the current graph 'gr' (the copy stored  */
+/* in 'st') and its reference 'cur' (see ST.h), the buffer    */
+/* 'grProx' for the candidates, the state 'rng' of its        */
+/* pseudo-random generator, the number of MC 'steps' to       */
+/* compute and of 'accept'ed graphs. The acceptance           */
+/* probabilities 'acc' (see 'accTable'), or the thresholds    */
+/* 'thr' of the Gibbs kernel (see 'gibbsTable'), are shared   */
+/* (read only) by all the chains with the same penalty        */
+/* constant 'penal'. When the marginal probabilities of the   */
+/* edges are computed, 'incl[e]' counts the states with the   */
+/* edge 'e' (up to the step 'since[e]' in which it was last   */
+/* changed) and 'clock' is the number of counted states (see  */
+/* 'margFlip'). The convergence diagnostics follow the        */
+/* values 'x' of the number of edges and of the               */
+/* non-normalized log-posterior probability (with penalty,    */
+/* from the "interaction energies" 'Vij') of the current      */
+/* graph, whose steps are added to the traces 'tr' (see       */
+/* Diag.h). The starting state is random or, in a warm        */
+/* sweep, a copy of the graph 'start' (see 'mcWarmSteps').    */
+typedef struct NEUROchain chainInfo;
+struct NEUROchain {
+   ST st;
+   STref cur;
+   Key gr, grProx;
+   double *acc, *Vij;
+   unsigned long *thr; /* (NULL for the Metropolis kernel) */
+   double penal; /* penalty constant of the chain */
+   Rng rng;
+   unsigned long steps, accept;
+   unsigned long *incl, *since, clock;
+   double x[2];
+   Trace tr[2];
+   Key start;
+};
+
+/* Summary of a Monte Carlo run with penalty 'penal': the     */
+/* maximum allowed and the computed number of MC steps, the   */
+/* number of accepted graphs, of counted graphs ('total')     */
+/* and of distinct graphs ('count'), the most representative  */
+/* graph 'max' and its counter 'maxCont' (which exceeds the   */
+/* true counter by at most 'err', see 'STerrBound'), and the  */
+/* non-normalized log-posterior probabilities (with and       */
+/* without penalty) of 'max' and its empirical probability    */
+/* at 'logPP' (see 'mcmc'), the marginal probabilities      */
+/* 'marg' of the edges (or NULL if they are not computed)     */
+/* and the effective sample sizes 'ess' and split-Rhat       */
+/* 'rhat' (0 if there is a single chain) of the number of     */
+/* edges and of the log-posterior (see 'chainsDiag').         */
+typedef struct NEUROresult resultInfo;
+struct NEUROresult {
+   double penal;
+   unsigned long maxMCsteps, steps, accept, total, maxCont, err;
+   int count;
+   Key max;
+   double logPP[3];
+   double *marg;
+   double ess[2], rhat[2];
+};
+
+/* State shared by the threads of a penalty sweep: the        */
+/* "interaction energies" 'Vij', the 'Npoints' penalty values */
+/* 'pen' and the streams 'rng' of their generators (see       */
+/* 'mcChains'), the summaries 'res' of the runs (with 'done' set    */
+/* when a run ends), the output files and the index 'next' of */
+/* the next point to be written. Points are written in order  */
+/* and, after more than 10 near-zero results ('zeros'), the   */
+/* points from 'cut' on are cancelled. When the points are    */
+/* computed by a pool, all the fields that change are         */
+/* protected by 'lock'.                                       */
+typedef struct NEUROsweep sweepInfo;
+struct NEUROsweep {
+   double *Vij;
+   double *pen;
+   Rng *rng;
+   int Npoints;
+   resultInfo *res;
+   int *done;
+   int next, zeros, cut;
+   spkInfo *tkt;
+   char *outName; /* general output */
+   FILE *out1, *out2, *out3; /* penal1, penal2 and penal3 files */
+   pthread_mutex_t lock;
+};
+
+/* State of a reweighted penalty sweep 's' (see               */
+/* 'penalReweight'): the 'Ntodo' points 'todo' to be computed */
+/* next and, for each point 'i' already computed (an anchor), */
+/* its symbol-table 'st[i]' (until it is merged into 'all')   */
+/* and the histogram 'Ha[i]' of the number of edges of its    */
+/* graphs ('Ha[i]' is NULL for the other points).             */
+typedef struct NEUROreweight reweightInfo;
+struct NEUROreweight {
+   sweepInfo *s;
+   int *todo, Ntodo;
+   ST *st, all;
+   double **Ha;
+};
+
+/* State of an adaptive penalty sweep 's' (see 'penalAdapt'): */
+/* the 'Ntodo' points 'todo' to be computed next (the points   */
+/* already computed have 's->done' set).                       */
+typedef struct NEUROadapt adaptInfo;
+struct NEUROadapt { sweepInfo *s; int *todo, Ntodo; };
+
+/* Most visited graph 'best[m]', with counter 'cont[m]', of   */
+/* each class of graphs with 'm' edges.                       */
+typedef struct NEUROclass classInfo;
+struct NEUROclass { unsigned long *cont; Key *best; };
 
 static long MEM; /* available memory */
 static int fixSteps; /* fixed number of MC steps option (0 or 1) */
@@ -52,6 +252,25 @@ static int Nneuron; /* number of neurons */
 static int Nedges; /* maximum number of edges */
 static int part; /* part of the experiment (1 or 3) */
 static char region[6]; /* brain region */
+static int stKind = STlist; /* symbol-table implementation */
+static int stChosen = 0; /* symbol-table chosen by the user (0 or 1) */
+static int topK = 0; /* maximum number of graphs of the 'STtopk' tables */
+static int marginals = 0; /* marginal probabilities of the edges option */
+static int Nchains = 1; /* number of independent chains */
+static unsigned long seed = 1; /* seed of the pseudo-random generators */
+static double tol = 0.0; /* tolerance of the stop rule (0: no rule) */
+static int ckptPeriod = 0; /* seconds between checkpoints (0: none) */
+static int resume = 0; /* resume from the checkpoint option */
+static char *ckptName = NULL; /* checkpoint file of the run (or NULL) */
+static pid_t ckptPid = 0; /* process writing a checkpoint (or 0) */
+static int Nthreads = 0; /* threads of the penalty sweep (0: all cores) */
+static int Nshare = 1; /* runs kept in memory at the same time */
+static int sweepKind = SWEEPgrid; /* penalty sweep */
+static int Nanchors = 16; /* anchor penalties of the reweighted sweep */
+static int adaptStride = 16; /* points between the coarse points */
+static double adaptTol = 0.0; /* largest gap not refined (in nats) */
+static int exact = 0; /* exact posterior (no Monte Carlo) option */
+static int kernel = KERNELmetropolis; /* sampling kernel */
 
 
 /* ********************************************************* */
@@ -79,7 +298,7 @@ void NEUROsetMCsteps (char *steps)
 void NEUROsetRegion (char *rg)
 {
    region[0] = '\0';
-   copy (region, rg);
+   strcpy (region, rg);
 
 } /* NEUROsetRegion */
 
@@ -106,492 +325,2793 @@ void NEUROsetMethod (char *method)
 {
    met = atoi (method);
 
-} /* NEUROsetMethod */
+} /* NEUROsetMethod */
+
+
+/* ********************************************************* */
+/* Sets the penalty constant chosen by the user.             */
+void NEUROsetPenal (char *penalty)
+{
+   penal = atof (penalty);
+
+} /* NEUROsetPenal */
+
+
+/* ********************************************************* */
+/* Sets the symbol-table implementation used to store the    */
+/* generated graphs: "list" for the skip list (default),     */
+/* "hash" for the hash table with open addressing or "none"  */
+/* for no histogram at all (only with the marginal           */
+/* probabilities of the edges, see 'NEUROsetMarginals').     */
+void NEUROsetST (char *kind)
+{
+   if (strcmp (kind, "list") == 0)
+      stKind = STlist;
+   else if (strcmp (kind, "hash") == 0)
+      stKind = SThash;
+   else if (strcmp (kind, "none") == 0)
+      stKind = STnone;
+   else {
+      fprintf (stderr, "\n Error: unknown symbol-table '%s'!\n\n", kind);
+      exit (EXIT_FAILURE);
+   }
+   stChosen = 1;
+
+} /* NEUROsetST */
+
+
+/* ********************************************************* */
+/* Sets the bounded symbol-table that keeps only the 'K'     */
+/* most visited graphs (approximately, see STtopk.c), so     */
+/* that the memory does not grow with the number of steps.   */
+void NEUROsetTopK (char *K)
+{
+   topK = atoi (K);
+   if (topK < 1) {
+      fprintf (stderr, "\n Error: invalid number of graphs '%s'!\n\n", K);
+      exit (EXIT_FAILURE);
+   }
+   stKind = STtopk;
+   stChosen = 1;
+
+} /* NEUROsetTopK */
+
+
+/* ********************************************************* */
+/* Sets the computation of the marginal (posterior)          */
+/* probability of each edge, i.e. the fraction of the MC     */
+/* states that have the edge. They do not need the histogram */
+/* of the graphs, so the symbol-table is disabled, unless    */
+/* one is chosen (see 'checkOptions').                       */
+void NEUROsetMarginals ()
+{
+   marginals = 1;
+
+} /* NEUROsetMarginals */
+
+
+/* ********************************************************* */
+/* Resolves the symbol-table implementation, after all the   */
+/* options are set (with the marginal probabilities and no   */
+/* symbol-table chosen by '--st' or '--topk', in any order,  */
+/* there is no histogram), and verifies if the chosen        */
+/* options can be used together.                             */
+static void checkOptions ()
+{
+   if (marginals && !stChosen)
+      stKind = STnone;
+   if (exact)
+      return; /* there are no chains */
+   if (stKind == STnone && !marginals) {
+      fprintf (stderr, "\n Error: '--st none' needs '--marginals'!\n\n");
+      exit (EXIT_FAILURE);
+   }
+   if (stKind == STnone && sweepKind == SWEEPreweight) {
+      fprintf (stderr, "\n Error: '--sweep reweight' needs the histograms"
+	       " (see '--st')!\n\n");
+      exit (EXIT_FAILURE);
+   }
+   if (stKind == STtopk && (ckptPeriod > 0 || resume)) {
+      /* The checkpoint keeps the counters, not their error bounds. */
+      fprintf (stderr, "\n Error: '--checkpoint' and '--resume' cannot be"
+	       " used with '--topk'!\n\n");
+      exit (EXIT_FAILURE);
+   }
+
+} /* checkOptions */
+
+
+/* ********************************************************* */
+/* Sets the number of independent Markov chains, each one    */
+/* computed by its own thread (the MC steps are split among  */
+/* the chains and their histograms are merged at the end).   */
+void NEUROsetChains (char *chains)
+{
+   Nchains = atoi (chains);
+   if (Nchains < 1) {
+      fprintf (stderr, "\n Error: invalid number of chains '%s'!\n\n", chains);
+      exit (EXIT_FAILURE);
+   }
+
+} /* NEUROsetChains */
+
+
+/* ********************************************************* */
+/* Sets the number of threads used to compute the penalty    */
+/* points of the penalty analysis at the same time ('0'      */
+/* means one thread per online processor).                   */
+void NEUROsetThreads (char *threads)
+{
+   Nthreads = atoi (threads);
+   if (Nthreads < 0) {
+      fprintf (stderr, "\n Error: invalid number of threads '%s'!\n\n",
+	       threads);
+      exit (EXIT_FAILURE);
+   }
+
+} /* NEUROsetThreads */
+
+
+/* ********************************************************* */
+/* Sets how the penalty analysis sweeps the penalty values:  */
+/* "grid" for an independent run at each value (default),    */
+/* "pt" for replica exchange (parallel tempering) among the  */
+/* runs of neighbouring values, "reweight" for histogram     */
+/* reweighting from some of the values (see                  */
+/* 'penalReweight'), "warm" for runs in order, each one      */
+/* starting from the previous one (see 'penalWarm'), or      */
+/* "adaptive" for runs only where the results change (see    */
+/* 'penalAdapt').                                            */
+void NEUROsetSweep (char *kind)
+{
+   if (strcmp (kind, "grid") == 0)
+      sweepKind = SWEEPgrid;
+   else if (strcmp (kind, "pt") == 0)
+      sweepKind = SWEEPpt;
+   else if (strcmp (kind, "reweight") == 0)
+      sweepKind = SWEEPreweight;
+   else if (strcmp (kind, "warm") == 0)
+      sweepKind = SWEEPwarm;
+   else if (strcmp (kind, "adaptive") == 0)
+      sweepKind = SWEEPadaptive;
+   else {
+      fprintf (stderr, "\n Error: unknown penalty sweep '%s'!\n\n", kind);
+      exit (EXIT_FAILURE);
+   }
+
+} /* NEUROsetSweep */
+
+
+/* ********************************************************* */
+/* Sets the number 'A' of anchor penalties of the reweighted */
+/* penalty sweep (see 'penalReweight').                      */
+void NEUROsetAnchors (char *A)
+{
+   Nanchors = atoi (A);
+   if (Nanchors < 2) {
+      fprintf (stderr, "\n Error: invalid number of anchors '%s'!\n\n", A);
+      exit (EXIT_FAILURE);
+   }
+
+} /* NEUROsetAnchors */
+
+
+/* ********************************************************* */
+/* Sets the number 'S' of points of the sweep between the    */
+/* coarse points of the adaptive penalty sweep (see          */
+/* 'penalAdapt').                                            */
+void NEUROsetStride (char *S)
+{
+   adaptStride = atoi (S);
+   if (adaptStride < 1) {
+      fprintf (stderr, "\n Error: invalid stride '%s'!\n\n", S);
+      exit (EXIT_FAILURE);
+   }
+
+} /* NEUROsetStride */
+
+
+/* ********************************************************* */
+/* Sets the tolerance 'T' (a gap of the log-posterior) above */
+/* which the results of two points of the adaptive penalty   */
+/* sweep differ (see 'refine').                              */
+void NEUROsetRefine (char *T)
+{
+   adaptTol = atof (T);
+   if (adaptTol < 0.0) {
+      fprintf (stderr, "\n Error: invalid tolerance '%s'!\n\n", T);
+      exit (EXIT_FAILURE);
+   }
+
+} /* NEUROsetRefine */
+
+
+/* ********************************************************* */
+/* Sets the seed of the pseudo-random generators, so that a  */
+/* run can be reproduced (see 'mcChains').                   */
+void NEUROsetSeed (char *number)
+{
+   char *end;
+
+   seed = strtoul (number, &end, 10);
+   if (*number == '\0' || *end != '\0') {
+      fprintf (stderr, "\n Error: invalid seed '%s'!\n\n", number);
+      exit (EXIT_FAILURE);
+   }
+
+} /* NEUROsetSeed */
+
+
+/* ********************************************************* */
+/* Sets the tolerance 'T' of the stop rule of the chains:    */
+/* they stop as soon as the Monte Carlo error of the means   */
+/* of the number of edges and of the log-posterior is at     */
+/* most 'T' times their standard deviations (i.e. both       */
+/* effective sample sizes reach '1/T^2') and, with several   */
+/* chains, both split-Rhat are at most '1+T' (see            */
+/* 'mcChains'). The maximum number of MC steps is kept.      */
+void NEUROsetTol (char *T)
+{
+   tol = atof (T);
+   if (tol <= 0.0 || tol >= 1.0) {
+      fprintf (stderr, "\n Error: invalid tolerance '%s'!\n\n", T);
+      exit (EXIT_FAILURE);
+   }
+
+} /* NEUROsetTol */
+
+
+/* ********************************************************* */
+/* Sets the number of seconds 'S' between the checkpoints of */
+/* the chains of 'bestGraph' (see 'ckptWrite').              */
+void NEUROsetCheckpoint (char *S)
+{
+   ckptPeriod = atoi (S);
+   if (ckptPeriod < 1) {
+      fprintf (stderr, "\n Error: invalid checkpoint period '%s'!\n\n", S);
+      exit (EXIT_FAILURE);
+   }
+
+} /* NEUROsetCheckpoint */
+
+
+/* ********************************************************* */
+/* Sets the chains of 'bestGraph' to resume from their last  */
+/* checkpoint, if there is one (see 'ckptLoad').             */
+void NEUROsetResume ()
+{
+   resume = 1;
+
+} /* NEUROsetResume */
+
+
+/* ********************************************************* */
+/* Sets the exact computation of the posterior (see          */
+/* 'exactPost') instead of the Markov Chain Monte Carlo.     */
+void NEUROsetExact ()
+{
+   exact = 1;
+
+} /* NEUROsetExact */
+
+
+/* ********************************************************* */
+/* Sets the sampling kernel of the chains: "metropolis" for  */
+/* one randomly chosen edge per step (default) or "gibbs"    */
+/* for a systematic scan of all edges per step (see          */
+/* 'gibbsSteps').                                            */
+void NEUROsetKernel (char *kind)
+{
+   if (strcmp (kind, "metropolis") == 0)
+      kernel = KERNELmetropolis;
+   else if (strcmp (kind, "gibbs") == 0)
+      kernel = KERNELgibbs;
+   else {
+      fprintf (stderr, "\n Error: unknown kernel '%s'!\n\n", kind);
+      exit (EXIT_FAILURE);
+   }
+
+} /* NEUROsetKernel */
+
+
+/* ********************************************************* */
+/* Prints the adjacency matrix representation of the key     */
+/* 'max' at 'std' file. The key is a graph in vector         */
+/* representation and, in order to maintain the coherence    */
+/* with other parts of the program, the rule is fill the     */
+/* elements below the main diagonal in row-major order.      */
+static void printAdjMatrix (FILE *std, Key max, spkInfo *tkt)
+{
+   int i, j;
+   char *adjMatrix;
+
+   /* Creates the matrix. */
+   adjMatrix = UTILmalloc (Nneuron * Nneuron * sizeof (char));
+
+   /* Initializes the matrix with "0s". */
+   for (i = 0; i < Nneuron; i++)
+      for (j = 0; j < Nneuron; j++)
+	 adjMatrix[idx2d(i,j,Nneuron)] = '0';
+
+   /*  *** This is an important "trick" of the algorithm!! ***  */
+   /* Copies the values of vector 'max' to the symmetric matrix */
+   /* following the rule of filling the elements below the      */
+   /* main diagonal in row-major order. Note that, 'i > j' and  */
+   /* 'idxAdj(i,j)' will give the correct index (see Item.h).   */
+   for (i = 1; i < Nneuron; i++)
+      for (j = 0; j < i; j++) {
+	 adjMatrix[idx2d(i,j,Nneuron)] = ITEMelem (max, idxAdj(i,j)) ? '1' : '0';
+	 adjMatrix[idx2d(j,i,Nneuron)] = adjMatrix[idx2d(i,j,Nneuron)];
+      }
+
+   /* Prints the matrix in 'std' file with the   */
+   /* electrodes labels at each column and line. */
+   fprintf (std, "    ");
+   for (i = 0; i < Nneuron; i++)
+      fprintf (std, " %s ", tkt[i].label);
+   fprintf (std, "\n");
+   for (i = 0; i < Nneuron; i++) {
+      fprintf (std, "%s ", tkt[i].label);
+      for (j = 0; j < Nneuron; j++)
+	 fprintf (std, "  %c  ", adjMatrix[idx2d(i,j,Nneuron)]);
+      fprintf (std, "\n");
+   }
+
+   free (adjMatrix);
+
+} /* printAdjMatrix */
+
+
+/* ********************************************************* */
+/* Prints at 'std' file the marginal probabilities 'marg' of */
+/* the edges in the layout of the adjacency matrix (see      */
+/* 'printAdjMatrix').                                        */
+static void printMargMatrix (FILE *std, double *marg, spkInfo *tkt)
+{
+   int i, j;
+
+   fprintf (std, "    ");
+   for (i = 0; i < Nneuron; i++)
+      fprintf (std, " %s ", tkt[i].label);
+   fprintf (std, "\n");
+   for (i = 0; i < Nneuron; i++) {
+      fprintf (std, "%s ", tkt[i].label);
+      for (j = 0; j < Nneuron; j++)
+	 fprintf (std, " %.2f", (i == j) ? 0.0 : marg[idxAdj(i,j)]);
+      fprintf (std, "\n");
+   }
+
+} /* printMargMatrix */
+
+
+/* ********************************************************* */
+/* Receives an output file name 'outName' and prints a lot   */
+/* of relevant information about the run 'res' (the code is  */
+/* quite self explanatory).                                  */
+static void output (char *outName, resultInfo *res, spkInfo *tkt)
+{
+   int i;
+   FILE *out; /* file for general output */
+
+   out = UTILfopen (outName, "a"); /* opens the general output file */
+
+   fprintf (out, "** Mouse %d - %s - part %d **\n", rat, region, part);
+   fprintf (out, "\nNumber of neurons: %d", Nneuron);
+   fprintf (out, "\nNeurons labels: ");
+   for (i = 0; i < Nneuron; i++)
+      fprintf (out, " %s ", tkt[i].label);
+   if (exact) { /* there are no chains */
+      fprintf (out, "\nExact posterior (no Monte Carlo)");
+      fprintf (out, "\nPenalty constant: %.5f", res->penal);
+   }
+   else {
+      fprintf (out, "\nMC steps: %lu", res->steps);
+      fprintf (out, "\nMaximum allowed MC steps: %lu", res->maxMCsteps);
+      if (Nchains > 1)
+	 fprintf (out, "\nIndependent chains: %d", Nchains);
+      fprintf (out, "\nTotal graphs counted: %lu", res->total);
+      fprintf (out, "\nPenalty constant: %.5f", res->penal);
+      fprintf (out, "\nDistinct graphs: %d", res->count);
+
+      fprintf (out, "\nAccepted graphs: %lu", res->accept);
+      fprintf (out, "\nEffective sample size (edges, log-posterior):"
+	       " %.1f %.1f", res->ess[0], res->ess[1]);
+      if (res->rhat[0] > 0.0)
+	 fprintf (out, "\nSplit R-hat (edges, log-posterior): %.4f %.4f",
+		  res->rhat[0], res->rhat[1]);
+   }
+   if (stKind == STnone && !exact) { /* there is no histogram */
+      fprintf (out, "\nMedian probability graph (vectorial form):\n");
+      ITEMshow (out, res->max); /* show in vectorial form */
+      fprintf (out, "\nMedian probability graph (adjacency matrix):\n");
+   }
+   else {
+      if (!exact) {
+	 fprintf (out, "\nMost representative graph counter = %lu",
+		  res->maxCont);
+	 if (stKind == STtopk)
+	    fprintf (out, "\nMost representative graph counter error <= %lu",
+		     res->err);
+      }
+      fprintf (out, "\nMost representative graph probability = %.5f",
+	       res->logPP[2]);
+      fprintf (out, "\nMost representative graph (vectorial form):\n");
+      ITEMshow (out, res->max); /* show in vectorial form */
+      fprintf (out, "\nMost representative graph (adjacency matrix):\n");
+   }
+   printAdjMatrix (out, res->max, tkt); /* show adjacency matrix */
+   if (res->marg != NULL) {
+      fprintf (out, "\nMarginal probabilities of the edges:\n");
+      printMargMatrix (out, res->marg, tkt);
+   }
+   fprintf (out, "\n\n");
+
+   fclose (out); /* closes the general output file */
+
+} /* output */
+
+
+/* ********************************************************* */
+/* Receives an output file name 'outName' and prints the     */
+/* adjacency matrix of the highest score graph 'max' in this */
+/* file.                                                     */
+static void outputAdjM (char *outName, Key max, spkInfo *tkt)
+{
+
+   FILE *out; /* file for adjacency matrix output */
+
+   out = UTILfopen (outName, "w"); /* opens the file */
+   printAdjMatrix (out, max, tkt); /* prints the adjacency matrix */
+   fclose (out); /* closes the file */
+
+} /* outputAdj */
+
+
+/* ********************************************************* */
+/* Receives an output file name 'outName' and prints the     */
+/* marginal probabilities 'marg' of the edges in this file.  */
+static void outputMarg (char *outName, double *marg, spkInfo *tkt)
+{
+   FILE *out; /* file for marginal probabilities output */
+
+   out = UTILfopen (outName, "w"); /* opens the file */
+   printMargMatrix (out, marg, tkt); /* prints the probabilities */
+   fclose (out); /* closes the file */
+
+} /* outputMarg */
+
+
+/* ********************************************************* */
+/* Creates the Monte Carlo starting state of the chain 'c'   */
+/* randomly (the probability of having each edge is 0.5).    */
+static Key MCinit (chainInfo *c)
+{
+   int i;
+   double u;
+   Key ini;
+
+   /* Allocates the graph (without edges). */
+   ini = ITEMnew ();
+
+   /* Decides (randomly) if each possible edge exists. */
+   for (i = 0; i < Nedges; i++) {
+      u = RNGunif (&c->rng); /* pseudo-random u ~ Unif[0,1] */
+      if (u >= 0.5) /* probability = 0.5 */
+	 ITEMgenerator (ini, i + 1); /* with edge */
+   }
+
+   return ini;
+
+} /* MCinit */
+
+
+/* ********************************************************* */
+/* Computes the sufficient statistics of the spikes of all   */
+/* neurons (see 'statsInfo') in a single pass. The bitsets   */
+/* are scanned in blocks of 'Nblock' words, so the blocks of */
+/* all neurons stay in the cache while all pairs are         */
+/* counted.                                                  */
+static statsInfo *spkStats (spkInfo *tkt)
+{
+   int i, j, g, b, n, len;
+   statsInfo *stats;
+
+   /* Allocates and initializes the statistics. */
+   stats = UTILmalloc (sizeof (statsInfo));
+   stats->count = UTILmalloc (Nneuron * sizeof (long));
+   stats->n11 = UTILmalloc ((Nneuron * (Nneuron - 1) / 2 + 1) * sizeof (long));
+   for (i = 0; i < Nneuron; i++)
+      stats->count[i] = 0;
+   for (g = 0; g < Nneuron * (Nneuron - 1) / 2; g++)
+      stats->n11[g] = 0;
+
+   /* Scans the spikes block by block. */
+   n = BITSwords (spkRange); /* words of the bitsets */
+   for (b = 0; b < n; b += Nblock) {
+      len = (n - b < Nblock) ? n - b : Nblock;
+      for (i = 0; i < Nneuron; i++)
+	 stats->count[i] += BITSpop (tkt[i].spikes + b, NULL, len, BITSone);
+      for (g = 0, i = 1; i < Nneuron; i++)
+	 for (j = 0; j < i; j++)
+	    stats->n11[g++] += BITSpop (tkt[i].spikes + b, tkt[j].spikes + b,
+					len, BITSand);
+   }
+
+   return stats;
+
+} /* *spkStats */
+
+
+/* ********************************************************* */
+/* Frees memory of the sufficient statistics.                */
+static void statsFree (statsInfo *stats)
+{
+   free (stats->count);
+   free (stats->n11);
+   free (stats);
+
+} /* statsFree */
+
+
+/* ********************************************************* */
+/* Computes the "interaction energies" between all possible  */
+/* neighbors. Given the spikes 'Xi' and 'Xj' of two neurons  */
+/* at each time window, their "interaction" is summed over   */
+/* the windows according to the method chosen:               */
+/*    1:  <Xi|Xj>=1 if Xi=1 and Xj=1.                        */
+/*    2:  <Xi|Xj>=1 if Xi=Xj or <Xi|Xj>=0 (if Xi!=Xj).       */
+/*    3:  <Xi|Xj>=1 if Xi=Xj=1, <Xi|Xj>=-1 if Xi!=Xj         */
+/*        or <Xi|Xj>=0 if Xi=Xj=0.                           */
+/* The sums are given by the sufficient statistics 'stats':  */
+/* there are 'n11' windows with 'Xi=Xj=1' and               */
+/* 'count[i]+count[j]-2*n11' windows with 'Xi!=Xj'.          */
+static double *gibbsEn (statsInfo *stats)
+{
+   int i, j, g;
+   long n11, n10; /* windows with Xi=Xj=1 and with Xi!=Xj */
+   double *Vij;
+
+   /* Allocates the "interaction energy" vector. */
+   Vij = UTILmalloc (Nedges * sizeof (double));
+
+   /*  *** This is an important "trick" of the algorithm!! ***  */
+   /* The index of the "interaction energy" vector must have    */
+   /* the same rule of the graph index when writing the         */
+   /* adjacency matrix. Here this rule is fill the elements     */
+   /* below the main diagonal in row-major order.               */
+   for (g = 0, i = 1; i < Nneuron; i++)
+      for (j = 0; j < i; j++, g++) {
+	 n11 = stats->n11[g];
+	 n10 = stats->count[i] + stats->count[j] - 2 * n11;
+	 if (met == 1) /* windows with Xi=Xj=1 */
+	    Vij[g] = Jij * n11;
+	 else if (met == 2) /* windows with Xi=Xj */
+	    Vij[g] = Jij * (spkRange - n10);
+	 else /* windows with Xi=Xj=1 minus windows with Xi!=Xj */
+	    Vij[g] = Jij * (n11 - n10);
+      }
+
+   return Vij;
+
+} /* *gibbsEn */
+
+
+/* ********************************************************* */
+/* Computes the acceptance probabilities of the Metropolis   */
+/* algorithm proposed originally by Metropolis et al (1954)  */
+/* with a symmetric sampling kernel ('Qij=Qji')              */
+/*           'a(i,j) = min {1, P(g_j|X)/P(g_i|X)}'           */
+/* where 'g_i' is the current state, 'g_j' is the candidate  */
+/* and 'P(g_i|X)' is the posterior probability. It is easy   */
+/* to see that the ratio 'P(g_j|X)/P(g_i|X)}' is given by    */
+/* one of the following options:                             */
+/*   1. 'exp(Jij*<Xi|Xj>-penal*spkRange)' if 'g_j' has one   */
+/*      more edge than 'g_i' (an edge has been inserted).    */
+/*   2. 'exp(penal*spkRange-Jij*<Xi|Xj>)' if 'g_j' has one   */
+/*      less edge than 'g_i' (an edge has been removed).     */
+/* As they only depend on the edge, they are computed once   */
+/* for the "interaction energies" 'Vij' and the penalty      */
+/* constant 'pen': the probabilities of inserting and of     */
+/* removing the edge 'e' are at the positions '2e' and       */
+/* '2e+1' of the returned vector (aligned at a cache line).  */
+static double *accTable (double *Vij, double pen)
+{
+   int e;
+   double x, *acc;
+
+   acc = UTILmemalign (CACHEline, 2 * Nedges * sizeof (double));
+   for (e = 0; e < Nedges; e++) {
+      x = Vij[e] - pen * spkRange;
+      acc[2*e] = (x >= 0.0) ? 1.0 : exp (x); /* insertion */
+      acc[2*e+1] = (x <= 0.0) ? 1.0 : exp (-x); /* removal */
+   }
+
+   return acc;
+
+} /* *accTable */
+
+
+/* ********************************************************* */
+/* Returns the thresholds of the Gibbs kernel for the        */
+/* "interaction energies" 'Vij' and the penalty constant     */
+/* 'pen'. The conditional probability of having the edge 'e' */
+/* given all the others is '1 / (1 + exp(-x))', where        */
+/* 'x = Vij[e] - pen spkRange' (it does not depend on the    */
+/* other edges), and it is kept as an integer threshold on   */
+/* the 53-bit random numbers: the edge is drawn when the     */
+/* number is smaller than '2^53' times the probability. The  */
+/* vector is aligned at a cache line.                        */
+static unsigned long *gibbsTable (double *Vij, double pen)
+{
+   int e;
+   double x, p;
+   unsigned long *thr;
+
+   thr = UTILmemalign (CACHEline, Nedges * sizeof (unsigned long));
+   for (e = 0; e < Nedges; e++) {
+      x = Vij[e] - pen * spkRange;
+      p = (x >= 0.0) ? 1.0 / (1.0 + exp (-x)) : exp (x) / (1.0 + exp (x));
+      thr[e] = (unsigned long) (p * 9007199254740992.0); /* 2^53 */
+   }
+
+   return thr;
+
+} /* *gibbsTable */
+
+
+/* ********************************************************* */
+/* Receives a candidate for a new state (the changed 'edge') */
+/* and returns '1' if it is accepted or '0' if not, with the */
+/* acceptance probabilities of the chain (see 'accTable').   */
+/* The information about which edge has been changed comes   */
+/* from the integer 'edge': if 'edge<0' it means that an     */
+/* edge has been removed, otherwise an edge has been         */
+/* inserted. The pseudo-random number is only drawn if the   */
+/* acceptance probability is less than 1.                    */
+/* Obs.: the addition of '1' in the 'edge' value was         */
+/* necessary to avoid mistake when the index is zero (see    */
+/* 'ITEMrandIdx' function at Item.c).                        */
+static int metropolis (chainInfo *c, int edge)
+{
+   double a;
+
+   /* Acceptance probability of inserting or removing the edge. */
+   a = c->acc[(edge > 0) ? 2 * edge - 2 : -2 * edge - 1];
+
+   if (a >= 1.0)
+      return 1; /* candidate accepted */
+
+   /* Generates u ~ Unif[0,1) and accepts if u < a. */
+   return (RNGunif (&c->rng) < a);
+
+} /* metropolis */
+
+
+/* ********************************************************* */
+/* Updates the inclusion counters of the chain 'c' when the  */
+/* 'edge' (see 'metropolis') changes and the new state is    */
+/* the 't'-th counted state. Each counter is only updated    */
+/* when its edge is removed, with the number of states since */
+/* it was inserted, so the cost is O(1) per accepted graph.  */
+static void margFlip (chainInfo *c, int edge, unsigned long t)
+{
+   if (edge < 0) /* removed: it was in the states since[e]..t-1 */
+      c->incl[-edge-1] += t - c->since[-edge-1];
+   else /* inserted */
+      c->since[edge-1] = t;
+
+} /* margFlip */
+
+
+/* ********************************************************* */
+/* Adds to the inclusion counters of the chain 'c' the       */
+/* states (up to the current 'clock') of the edges of its    */
+/* current graph, and restarts all of them at 'clock'.       */
+static void margFlush (chainInfo *c)
+{
+   int e;
+
+   for (e = 0; e < Nedges; e++) {
+      if (ITEMelem (c->gr, e))
+	 c->incl[e] += c->clock - c->since[e];
+      c->since[e] = c->clock;
+   }
+
+} /* margFlush */
+
+
+/* ********************************************************* */
+/* Returns the marginal probabilities of the edges, i.e. the */
+/* fraction of the counted states of the 'n' chains 'c' that */
+/* have each edge, and frees their counters.                 */
+static double *chainsMarg (chainInfo *c, int n)
+{
+   int k, e;
+   unsigned long total = 0;
+   double *marg;
+
+   marg = UTILmalloc (Nedges * sizeof (double));
+   for (e = 0; e < Nedges; e++)
+      marg[e] = 0.0;
+   for (k = 0; k < n; k++) {
+      margFlush (&c[k]);
+      for (e = 0; e < Nedges; e++)
+	 marg[e] += c[k].incl[e];
+      total += c[k].clock;
+      free (c[k].incl);
+      free (c[k].since);
+   }
+   for (e = 0; e < Nedges; e++)
+      marg[e] /= total;
+
+   return marg;
+
+} /* *chainsMarg */
+
+
+/* ********************************************************* */
+/* Computes the values 'c->x' of the current graph 'c->gr'   */
+/* of the chain 'c': its number of edges and its             */
+/* non-normalized log-posterior probability (with penalty).  */
+static void chainValues (chainInfo *c)
+{
+   int e;
+
+   c->x[0] = ITEMcount (c->gr);
+   c->x[1] = 0.0;
+   for (e = 0; e < Nedges; e++)
+      if (ITEMelem (c->gr, e))
+	 c->x[1] += c->Vij[e] - c->penal * spkRange;
+
+} /* chainValues */
+
+
+/* ********************************************************* */
+/* Adds 'w' steps at the current graph of the chain 'c' to   */
+/* its traces.                                               */
+static void traceAdd (chainInfo *c, unsigned long w)
+{
+   if (w > 0) {
+      DIAGadd (c->tr[0], c->x[0], w);
+      DIAGadd (c->tr[1], c->x[1], w);
+   }
+
+} /* traceAdd */
+
+
+/* ********************************************************* */
+/* Fills the effective sample sizes 'ess' (the sums of the   */
+/* ones of the chains) and the split-Rhat 'rhat' (0 if there */
+/* is a single chain) of the 'n' chains 'c'.                 */
+static void chainsDiag (chainInfo *c, int n, double *ess, double *rhat)
+{
+   int k, q;
+   Trace *t;
+
+   t = UTILmalloc (n * sizeof (Trace));
+   for (q = 0; q < 2; q++) {
+      ess[q] = 0.0;
+      for (k = 0; k < n; k++) {
+	 ess[q] += DIAGess (c[k].tr[q]);
+	 t[k] = c[k].tr[q];
+      }
+      rhat[q] = (n > 1) ? DIAGrhat (t, n) : 0.0;
+   }
+   free (t);
+
+} /* chainsDiag */
+
+
+/* ********************************************************* */
+/* Systematic scan of the Gibbs kernel: draws every edge of  */
+/* the graph 'g' of the chain 'c', in order, from its exact  */
+/* conditional probability (see 'gibbsTable'), so there are  */
+/* no rejections. The edges are drawn a word of the graph at */
+/* a time: the random numbers are generated first and then   */
+/* compared with the thresholds without branches, giving the */
+/* new word at once (see 'ITEMassign'). The changes of the   */
+/* values of the graph (see 'chainValues') are added to 'dx' */
+/* and, if 't > 0', the inclusion counters are updated with  */
+/* 'g' as the 't'-th counted state (see 'margFlip'). Returns */
+/* the number of edges that changed.                         */
+static int gibbsSweep (chainInfo *c, Key g, unsigned long t, double *dx)
+{
+   int e, j, n, w, edge, flips = 0;
+   unsigned long bits, d;
+   unsigned long r[BITSword]; /* random numbers of a word */
+
+   for (w = 0, e = 0; e < Nedges; w++, e += BITSword) {
+      n = (Nedges - e < BITSword) ? Nedges - e : BITSword;
+      for (j = 0; j < n; j++)
+	 r[j] = RNGnext (&c->rng) >> 11; /* 53 bits */
+      for (bits = 0, j = 0; j < n; j++)
+	 bits |= (unsigned long) (r[j] < c->thr[e+j]) << (BITSword - 1 - j);
+      d = ITEMassign (g, w, bits);
+
+      /* Changed edges (from the most significant bit). */
+      for (j = 0; d != 0; j++, d <<= 1)
+	 if (d >> (BITSword - 1)) {
+	    flips++;
+	    edge = ((bits >> (BITSword - 1 - j)) & 1UL) ? e + j + 1
+	       : -(e + j + 1);
+	    dx[0] += (edge > 0) ? 1 : -1;
+	    dx[1] += (edge > 0) ? c->Vij[e+j] - c->penal * spkRange
+	       : c->penal * spkRange - c->Vij[e+j];
+	    if (t > 0 && c->incl != NULL) /* marginal probabilities */
+	       margFlip (c, edge, t);
+	 }
+   }
+
+   return flips;
+
+} /* gibbsSweep */
+
+
+/* ********************************************************* */
+/* Given an initial state 'c->gr', whose values are 'c->x'   */
+/* (see 'chainValues'), it computes 'n' Monte Carlo steps    */
+/* without including the generated graphs into the accepted  */
+/* graphs list. This "thermalization steps" are used reduce  */
+/* the importance of choosing the initial state. After all   */
+/* the steps, the resulting graph 'c->gr' is taken as the    */
+/* initial state of the Monte Carlo. Returns the mean        */
+/* log-posterior probability of the steps and, if 'se' is    */
+/* not NULL, its standard error at '*se', estimated from the */
+/* means of 'WARMbatches' consecutive batches of the steps   */
+/* (which, unlike the steps, are nearly independent). With   */
+/* the Gibbs kernel, the same number of edges are drawn by   */
+/* 'n/Nedges' scans (at least one).                          */
+static double mcThermSteps (chainInfo *c, int n, double *se)
+{
+   int i, b, nb;
+   int edge;
+   double mean, d, sum[WARMbatches]; /* sums of the batches */
+   double dx[2];
+
+   if (c->thr != NULL) /* Gibbs kernel */
+      n = (n / Nedges > 0) ? n / Nedges : 1;
+   nb = (n < WARMbatches) ? n : WARMbatches;
+   for (b = 0; b < nb; b++)
+      sum[b] = 0.0;
+
+   if (c->thr != NULL) { /* Gibbs kernel */
+      for (i = 0; i < n; i++) {
+	 dx[0] = dx[1] = 0.0;
+	 gibbsSweep (c, c->gr, 0, dx);
+	 c->x[1] += dx[1];
+	 sum[i * nb / n] += c->x[1];
+      }
+   }
+   else /* 'n' Monte Carlo steps. */
+      for (i = 0; i < n; i++) {
+
+	 /* Chooses a random edge to change. */
+	 edge = ITEMrandIdx (c->gr, (int) RNGbounded (&c->rng, Nedges));
+
+	 /* metropolis = 1 if the candidate is accepted. */
+	 if (metropolis (c, edge) == 1) {
+
+	    /* Changes the edge (inserts if 'edge > 0' */
+	    /* or removes if 'edge < 0').              */
+	    ITEMgenerator (c->gr, edge);
+	    c->x[1] += (edge > 0) ? c->Vij[edge-1] - c->penal * spkRange
+	       : c->penal * spkRange - c->Vij[-edge-1];
+
+	 }
+	 sum[i * nb / n] += c->x[1];
+
+      } /* for (i = 0; i ... */
+
+   /* Mean and its standard error (from the batch means). */
+   for (mean = 0.0, b = 0; b < nb; b++)
+      mean += sum[b];
+   mean /= n;
+   if (se != NULL) {
+      *se = 0.0;
+      for (b = 0; nb > 1 && b < nb; b++) {
+	 d = sum[b] / ((b + 1) * n / nb - b * n / nb) - mean;
+	 *se += d * d / (nb * (nb - 1.0));
+      }
+      *se = sqrt (*se);
+   }
+
+   return mean;
+
+} /* mcThermSteps */
+
+
+/* ********************************************************* */
+/* Thermalization of the chain 'c' started from a graph of a */
+/* neighbouring penalty (the final state of its previous     */
+/* run in a warm sweep), which is already close to the       */
+/* equilibrium: the steps are done in blocks of 'WARMsweeps' */
+/* steps per edge (so that every edge is likely proposed     */
+/* several times) until the mean log-posterior of a block    */
+/* is within 'WARMz' standard errors of the mean of the      */
+/* previous block (in either direction, as the chain may     */
+/* relax up or down from the previous penalty), with at      */
+/* least 'WARMmin' blocks and at most the 'Nsteps' steps of  */
+/* a random start.                                           */
+static void mcWarmSteps (chainInfo *c)
+{
+   int n, t, blocks;
+   double x, prev, se, sePrev;
+
+   n = WARMsweeps * Nedges;
+   if (n > Nsteps)
+      n = Nsteps;
+
+   chainValues (c);
+   prev = mcThermSteps (c, n, &sePrev);
+   for (blocks = 1, t = n; t + n <= Nsteps; t += n) {
+      x = mcThermSteps (c, n, &se);
+      blocks++;
+      if (blocks >= WARMmin
+	  && fabs (x - prev) <= WARMz * sqrt (se * se + sePrev * sePrev))
+	 break; /* no drift left */
+      prev = x;
+      sePrev = se;
+   }
+
+} /* mcWarmSteps */
+
+
+/* ********************************************************* */
+/* Computes 'n' steps of the Gibbs kernel from the state     */
+/* 'c->gr' of the chain 'c': each step is a systematic scan  */
+/* of all edges (see 'gibbsSweep') and the graph at its end  */
+/* is the counted state of the step, which is added to the   */
+/* symbol-table of the chain in the same way as the steps of */
+/* 'mcSteps' (a scan that changes no edge counts as a        */
+/* rejected candidate). Returns the number of accepted       */
+/* graphs, i.e. of scans that changed the graph.             */
+static int gibbsSteps (chainInfo *c, int n)
+{
+   int i;
+   int accept; /* # of accepted graphs */
+   unsigned long dwell; /* steps at 'gr' not counted yet */
+   double dx[2]; /* changes of the values of the graph */
+
+   for (dwell = 0, accept = 0, i = 0; i < n; i++) {
+
+      /* Draws the new graph. */
+      copy (c->grProx, c->gr); /* grProx = gr*/
+      dx[0] = dx[1] = 0.0;
+      if (gibbsSweep (c, c->grProx, c->clock + i, dx) > 0) {
+
+	 accept++; /* one more graph */
+
+	 /* Counts the steps at the current graph (see 'mcSteps'). */
+	 STrefAdd (c->st, c->cur, dwell);
+	 traceAdd (c, dwell + (accept > 1));
+	 dwell = 0;
+	 c->x[0] += dx[0];
+	 c->x[1] += dx[1];
+
+	 /* Increments the counter of 'grProx' at graphs list */
+	 /* (adding a copy if it is not there yet).           */
+	 c->cur = STaddRef (c->st, c->grProx, 1);
+	 c->gr = STrefItem (c->st, c->cur);
+
+      }
+      else /* the same graph */
+	 dwell++; /* one more step at 'gr' */
+
+   } /* for (i = 0; i ... */
+
+   STrefAdd (c->st, c->cur, dwell);
+   traceAdd (c, dwell + (accept > 0));
+   c->clock += n;
+
+   return accept;
+
+} /* gibbsSteps */
+
+
+/* ********************************************************* */
+/* Given an initial state 'c->gr', it computes 'n' Monte     */
+/* Carlo steps. Each accepted state is included into         */
+/* the accepted graphs list (symbol-table - see ST.h) of the */
+/* chain. The candidate graphs are built in the buffer       */
+/* 'c->grProx', which is reused at every step (the           */
+/* symbol-table stores its own copies), and 'c->gr' always   */
+/* points to the copy stored in the symbol-table. The steps  */
+/* that stay at the current graph (rejected candidates) are  */
+/* only counted, through its reference 'c->cur', when the    */
+/* chain moves and at the end, so that the symbol-table is   */
+/* searched once per accepted graph and its counters (and    */
+/* its highest score item) are exact when this function      */
+/* returns. If the marginal probabilities of the edges are   */
+/* computed, the 'i'-th step gives the state 'c->clock + i'  */
+/* (see 'margFlip'). The steps are added to the traces in    */
+/* the same way, when the chain moves and at the end.        */
+/* Returns the number of accepted graphs. With the Gibbs     */
+/* kernel, the steps are computed by 'gibbsSteps'.           */
+static int mcSteps (chainInfo *c, int n)
+{
+   int i;
+   int accept; /* # of accepted graphs */
+   int edge; /* index of the changed edge */
+   unsigned long dwell; /* steps at 'gr' not counted yet */
+   double dx; /* change of the log-posterior */
+
+   if (c->thr != NULL)
+      return gibbsSteps (c, n);
+
+   /* 'n' Monte Carlo steps. */
+   for (dwell = 0, accept = 0, i = 0; i < n; i++) {
+
+      /* Chooses a random edge to change. */
+      edge = ITEMrandIdx (c->gr, (int) RNGbounded (&c->rng, Nedges));
+
+      /* metropolis = 1 if the candidate is accepted. */
+      if (metropolis (c, edge) == 1) {
+
+	 accept++; /* one more graph */
+	 if (c->incl != NULL) /* marginal probabilities */
+	    margFlip (c, edge, c->clock + i);
+
+	 /* Counts the steps at the current graph (the */
+	 /* previous graph accepted in this call was   */
+	 /* counted once more when it was added).      */
+	 STrefAdd (c->st, c->cur, dwell);
+	 traceAdd (c, dwell + (accept > 1));
+	 dwell = 0;
+	 dx = (edge > 0) ? c->Vij[edge-1] - c->penal * spkRange
+	    : c->penal * spkRange - c->Vij[-edge-1];
+	 c->x[0] += (edge > 0) ? 1 : -1;
+	 c->x[1] += dx;
+
+	 /* Builds the new graph. */
+	 copy (c->grProx, c->gr); /* grProx = gr*/
+	 ITEMgenerator (c->grProx, edge); /* changes the edge (and its hash) */
+
+	 /* Increments the counter of 'grProx' at graphs list */
+	 /* (adding a copy if it is not there yet).           */
+	 c->cur = STaddRef (c->st, c->grProx, 1);
+	 c->gr = STrefItem (c->st, c->cur);
+
+      }
+      else /* candidate rejected */
+	 dwell++; /* one more step at 'gr' */
+
+   } /* for (i = 0; i ... */
+
+   STrefAdd (c->st, c->cur, dwell);
+   traceAdd (c, dwell + (accept > 0));
+   c->clock += n;
+
+   return accept;
+
+} /* mcSteps */
+
+
+/* ********************************************************* */
+/* Starts the chain 'c': generates its starting state, does  */
+/* the "thermalization" steps and creates its own            */
+/* symbol-table with the starting state.                     */
+static void mcStart (chainInfo *c)
+{
+   int i;
+   Item item; /* symbol-table object */
+
+   if (c->start == NULL) {
+      /* First graph generated randomly. */
+      c->gr = MCinit (c);
+
+      /* "Thermalization" steps. */
+      chainValues (c);
+      mcThermSteps (c, Nsteps, NULL);
+   }
+   else { /* warm start */
+      c->gr = ITEMnew ();
+      copy (c->gr, c->start);
+      mcWarmSteps (c);
+   }
+
+   /* Creates and initializes the symbol-table. */
+   key(item) = c->gr;
+   c->st = STinit (stKind, topK); /* creates the symbol-table */
+   c->grProx = c->gr; /* reuses the initial graph as buffer */
+   c->cur = STaddRef (c->st, item, 1); /* insert a copy of 'gr' */
+   c->gr = STrefItem (c->st, c->cur);
+   c->accept = 1; /* # of accepted graphs */
+
+   /* Traces of the diagnostics with the starting state. */
+   c->tr[0] = DIAGinit ();
+   c->tr[1] = DIAGinit ();
+   chainValues (c);
+   traceAdd (c, 1);
+
+   /* Counters of the marginal probabilities (the starting */
+   /* state is the counted state 0).                       */
+   c->clock = 1;
+   c->incl = c->since = NULL;
+   if (marginals) {
+      c->incl = UTILmalloc (Nedges * sizeof (unsigned long));
+      c->since = UTILmalloc (Nedges * sizeof (unsigned long));
+      for (i = 0; i < Nedges; i++)
+	 c->incl[i] = c->since[i] = 0;
+   }
+
+} /* mcStart */
+
+
+/* ********************************************************* */
+/* Task of a pool of chains: starts the chain 'i' of the     */
+/* vector of chains 'arg'.                                   */
+static void chainStart (Pool p, int i, void *arg)
+{
+   mcStart ((chainInfo *) arg + i);
+
+} /* chainStart */
+
+
+/* ********************************************************* */
+/* Task of a pool of chains: computes 'Nsteps' Monte Carlo   */
+/* steps of the chain 'i' of the vector of chains 'arg'.     */
+static void chainSteps (Pool p, int i, void *arg)
+{
+   chainInfo *c = (chainInfo *) arg + i;
+
+   c->accept += mcSteps (c, Nsteps);
+
+} /* chainSteps */
+
+
+/* ********************************************************* */
+/* Returns '1' if the 'n' chains 'c' satisfy the stop rule   */
+/* with tolerance 'tol' (see 'NEUROsetTol') or '0' if not.   */
+static int converged (chainInfo *c, int n)
+{
+   int q;
+   double ess[2], rhat[2];
+
+   chainsDiag (c, n, ess, rhat);
+   for (q = 0; q < 2; q++)
+      if (ess[q] * tol * tol < 1.0 || (n > 1 && rhat[q] > 1.0 + tol))
+	 return 0;
+
+   return 1;
+
+} /* converged */
+
+
+/* ********************************************************* */
+/* Adds the counter 'cont' of the graph 'item' to the        */
+/* symbol-table 'st' (used to merge the chains histograms).  */
+static void mergeGraph (Item item, unsigned long cont, void *st)
+{
+   STadd (st, item, cont);
+
+} /* mergeGraph */
+
+
+/* ********************************************************* */
+/* Writes at the binary file 'out' the counter 'cont' and    */
+/* the graph 'item' of a histogram (see 'ckptDump').         */
+static void dumpGraph (Item item, unsigned long cont, void *out)
+{
+   fwrite (&cont, sizeof (unsigned long), 1, out);
+   ITEMwrite (out, item);
+
+} /* dumpGraph */
+
+
+/* ********************************************************* */
+/* Counts at '*n' the graphs of a histogram.                 */
+static void countGraph (Item item, unsigned long cont, void *n)
+{
+   (*(unsigned long *) n)++;
+
+} /* countGraph */
+
+
+/* ********************************************************* */
+/* Writes at the binary file 'out' the header 'h' and the    */
+/* state of the 'Nchains' chains 'c' (see 'ckptHeader').     */
+static void ckptDump (FILE *out, ckptHeader *h, chainInfo *c)
+{
+   int k;
+   ckptChain cc;
+
+   fwrite (h, sizeof (ckptHeader), 1, out);
+   for (k = 0; k < Nchains; k++) {
+      cc.rng = c[k].rng;
+      cc.steps = c[k].steps;
+      cc.accept = c[k].accept;
+      cc.clock = c[k].clock;
+      cc.Nitems = 0;
+      STwalk (c[k].st, countGraph, &cc.Nitems);
+      fwrite (&cc, sizeof (ckptChain), 1, out);
+      ITEMwrite (out, c[k].gr);
+      DIAGwrite (out, c[k].tr[0]);
+      DIAGwrite (out, c[k].tr[1]);
+      if (marginals) {
+	 fwrite (c[k].incl, sizeof (unsigned long), Nedges, out);
+	 fwrite (c[k].since, sizeof (unsigned long), Nedges, out);
+      }
+      STwalk (c[k].st, dumpGraph, out);
+   }
+
+} /* ckptDump */
+
+
+/* ********************************************************* */
+/* Fills the header 'h' of the checkpoint of a run with      */
+/* 'maxMCsteps' steps after 'round' rounds of the chains.    */
+static void ckptSetHeader (ckptHeader *h, unsigned long maxMCsteps,
+			   unsigned long round)
+{
+   memset (h, 0, sizeof (ckptHeader)); /* no garbage at the file */
+   h->magic = CKPTmagic;
+   h->version = CKPTversion;
+   h->wordSize = sizeof (unsigned long);
+   h->mouse = rat;
+   h->part = part;
+   h->met = met;
+   h->Nedges = Nedges;
+   h->Nchains = Nchains;
+   h->stKind = stKind;
+   h->topK = topK;
+   h->marginals = marginals;
+   h->kernel = kernel;
+   strcpy (h->region, region);
+   h->penal = penal;
+   h->seed = seed;
+   h->maxMCsteps = maxMCsteps;
+   h->round = round;
+
+} /* ckptSetHeader */
+
+
+/* ********************************************************* */
+/* Saves the state of the 'Nchains' chains 'c' of a run with */
+/* 'maxMCsteps' steps, after 'round' rounds, at the file     */
+/* 'ckptName'. The file is written by a child process, which */
+/* has its own copy of the memory (copy-on-write), so that   */
+/* the chains go on at once. It is written at a temporary    */
+/* file that is then renamed, so that a run killed at any    */
+/* time leaves a complete checkpoint. If the previous        */
+/* checkpoint is still being written, this one is skipped,   */
+/* unless it is the 'last' one (then it waits for it). It    */
+/* must be called when the chains are not running: as only   */
+/* the calling thread exists at the child, no other thread   */
+/* can hold a lock of the libraries.                         */
+static void ckptWrite (chainInfo *c, unsigned long maxMCsteps,
+		       unsigned long round, int last)
+{
+   pid_t pid;
+   ckptHeader h;
+   char *tmpName;
+   FILE *out;
+
+   /* Previous checkpoint. */
+   if (ckptPid > 0) {
+      if (waitpid (ckptPid, NULL, last ? 0 : WNOHANG) == 0)
+	 return; /* still being written */
+      ckptPid = 0;
+   }
+
+   pid = fork ();
+   if (pid < 0) {
+      fprintf (stderr, "\n Warning: could not write a checkpoint!\n");
+      return;
+   }
+   if (pid > 0) { /* the chains go on */
+      ckptPid = pid;
+      return;
+   }
+
+   /* Child process: writes the checkpoint and exits. */
+   tmpName = UTILmalloc ((strlen (ckptName) + 5) * sizeof (char));
+   sprintf (tmpName, "%s.tmp", ckptName);
+   out = fopen (tmpName, "wb");
+   if (out == NULL)
+      _exit (EXIT_FAILURE);
+   ckptSetHeader (&h, maxMCsteps, round);
+   ckptDump (out, &h, c);
+   if (fclose (out) != 0 || rename (tmpName, ckptName) != 0) {
+      remove (tmpName);
+      _exit (EXIT_FAILURE);
+   }
+   _exit (EXIT_SUCCESS);
+
+} /* ckptWrite */
+
+
+/* ********************************************************* */
+/* Reads the state of the chain 'c' from the checkpoint file */
+/* 'in' and rebuilds its symbol-table. Returns 1 on success  */
+/* or 0 if not.                                              */
+static int ckptReadChain (FILE *in, chainInfo *c)
+{
+   unsigned long i, cont;
+   ckptChain cc;
+   Item item;
+
+   if (fread (&cc, sizeof (ckptChain), 1, in) != 1)
+      return 0;
+   c->rng = cc.rng;
+   c->steps = cc.steps;
+   c->accept = cc.accept;
+   c->clock = cc.clock;
+
+   /* Current graph and traces. */
+   c->grProx = ITEMnew (); /* buffer of the candidates */
+   if (!ITEMread (in, c->grProx))
+      return 0;
+   c->tr[0] = DIAGread (in);
+   c->tr[1] = DIAGread (in);
+   if (c->tr[0] == NULL || c->tr[1] == NULL)
+      return 0;
+
+   /* Counters of the marginal probabilities. */
+   c->incl = c->since = NULL;
+   if (marginals) {
+      c->incl = UTILmalloc (Nedges * sizeof (unsigned long));
+      c->since = UTILmalloc (Nedges * sizeof (unsigned long));
+      if (fread (c->incl, sizeof (unsigned long), Nedges, in)
+	  != (size_t) Nedges
+	  || fread (c->since, sizeof (unsigned long), Nedges, in)
+	  != (size_t) Nedges)
+	 return 0;
+   }
+
+   /* Histogram. */
+   c->st = STinit (stKind, topK);
+   item = ITEMnew ();
+   for (i = 0; i < cc.Nitems; i++) {
+      if (fread (&cont, sizeof (unsigned long), 1, in) != 1
+	  || !ITEMread (in, item))
+	 return 0;
+      STadd (c->st, item, cont);
+   }
+   ITEMfree (item);
+   c->cur = STaddRef (c->st, c->grProx, 0);
+   c->gr = STrefItem (c->st, c->cur);
+   chainValues (c);
+
+   return 1;
+
+} /* ckptReadChain */
+
+
+/* ********************************************************* */
+/* Resumes the 'Nchains' chains 'c' of a run with            */
+/* 'maxMCsteps' steps from the checkpoint file 'ckptName'    */
+/* and returns the number of rounds already computed. If     */
+/* there is no checkpoint of this run, it returns 0 and the  */
+/* chains are not touched.                                   */
+static unsigned long ckptLoad (chainInfo *c, unsigned long maxMCsteps)
+{
+   int k;
+   ckptHeader h, exp;
+   FILE *in;
+
+   in = fopen (ckptName, "rb");
+   if (in == NULL)
+      return 0; /* no checkpoint */
+
+   ckptSetHeader (&exp, maxMCsteps, 0);
+   if (fread (&h, sizeof (ckptHeader), 1, in) != 1 || h.round == 0) {
+      fclose (in);
+      return 0;
+   }
+   exp.round = h.round;
+   if (memcmp (&h, &exp, sizeof (ckptHeader)) != 0) {
+      fprintf (stderr, "\n Warning: checkpoint '%s' is from another run"
+	       " (it is ignored)!\n", ckptName);
+      fclose (in);
+      return 0;
+   }
+
+   for (k = 0; k < Nchains; k++)
+      if (!ckptReadChain (in, &c[k])) {
+	 fprintf (stderr, "\n Error: checkpoint '%s' is corrupted!\n\n",
+		  ckptName);
+	 exit (EXIT_FAILURE);
+      }
+   fclose (in);
+   printf ("\n Resuming from checkpoint '%s'", ckptName);
+
+   return h.round;
+
+} /* ckptLoad */
+
+
+/* ********************************************************* */
+/* Runs 'Nchains' independent chains with the "interaction   */
+/* energies" 'Vij' and the penalty constant 'pen', splitting */
+/* among them the blocks of 'Nsteps' steps needed to reach   */
+/* 'maxMCsteps'. The chains run at the same time, each one   */
+/* at its own thread (see Pool.h), in rounds of one block,   */
+/* and, if there is a stop rule (see 'NEUROsetTol'), they    */
+/* stop after the first round in which it is satisfied.      */
+/* Chain 'k' has its own starting state, its own             */
+/* symbol-table and its own generator, whose stream is the   */
+/* one of 'rng' jumped ahead 'k' times (see Rng.h). At the   */
+/* end all the histograms are merged into the symbol-table   */
+/* of chain 0, which is returned, and the summary 'res' gets */
+/* the total of MC 'steps' and 'accept'ed graphs of all      */
+/* chains, the sum 'err' of the error bounds of the counters */
+/* of the chains 1, 2, ... (the bound of the merged counters */
+/* is 'err' plus the bound of the returned symbol-table),    */
+/* the convergence diagnostics and, if chosen, the marginal  */
+/* probabilities 'marg' of the edges. If there is a          */
+/* checkpoint file 'ckptName' (only for 'bestGraph'), the    */
+/* chains can resume from it and, with a 'ckptPeriod', they  */
+/* are saved at it after the first round of each period and  */
+/* at the end. If 'start' is not NULL, the chain 'k' starts  */
+/* from the graph 'start[k]' (or randomly, if it is NULL)    */
+/* and its final graph is copied back to 'start[k]'.         */
+static ST mcChains (double *Vij, double pen, Rng *rng,
+		    unsigned long maxMCsteps, Key *start, resultInfo *res)
+{
+   int k, q, n;
+   time_t next; /* time of the next checkpoint */
+   unsigned long r, r0, rounds; /* rounds of one block of 'Nsteps' */
+   unsigned long blocks; /* # of blocks of 'Nsteps' steps */
+   chainInfo *c; /* vector of chains */
+   double *acc; /* acceptance probabilities */
+   unsigned long *thr; /* thresholds of the Gibbs kernel */
+   ST st; /* merged symbol-table */
+
+   c = UTILmalloc (Nchains * sizeof (chainInfo));
+
+   /* Initializes the chains. */
+   acc = accTable (Vij, pen);
+   thr = (kernel == KERNELgibbs) ? gibbsTable (Vij, pen) : NULL;
+   blocks = (maxMCsteps + Nsteps - 1) / Nsteps;
+   rounds = (blocks + Nchains - 1) / Nchains;
+   for (k = 0; k < Nchains; k++) {
+      c[k].acc = acc;
+      c[k].thr = thr;
+      c[k].Vij = Vij;
+      c[k].penal = pen;
+      c[k].steps = (blocks / Nchains + (k < blocks % Nchains)) * Nsteps;
+      c[k].rng = (k == 0) ? *rng : c[k-1].rng;
+      if (k > 0)
+	 RNGjump (&c[k].rng); /* independent stream */
+      c[k].start = (start != NULL) ? start[k] : NULL;
+   }
+
+   /* Runs the chains (in the last round, only the chains */
+   /* '0' to 'n-1' still have steps to compute).          */
+   r0 = (ckptName != NULL && resume) ? ckptLoad (c, maxMCsteps) : 0;
+   if (r0 == 0)
+      POOLrun (Nchains, Nchains, chainStart, c);
+   next = time (NULL) + ckptPeriod;
+   for (r = r0; r < rounds; r++) {
+      for (n = 0; n < Nchains && c[n].steps > r * Nsteps; n++);
+      POOLrun (Nchains, n, chainSteps, c);
+      if (tol > 0.0 && r + 1 < rounds && converged (c, Nchains))
+	 break; /* stop rule */
+      if (ckptPeriod > 0 && time (NULL) >= next) {
+	 ckptWrite (c, maxMCsteps, r + 1, 0);
+	 next = time (NULL) + ckptPeriod;
+      }
+   }
+   for (k = 0; k < Nchains; k++)
+      if (c[k].steps > (r + 1) * Nsteps)
+	 c[k].steps = (r + 1) * Nsteps; /* stopped */
+   if (ckptPeriod > 0) /* the finished run */
+      ckptWrite (c, maxMCsteps, rounds, 1);
+   for (k = 0; k < Nchains; k++) {
+      if (start != NULL) { /* starting state of the next run */
+	 if (start[k] == NULL)
+	    start[k] = ITEMnew ();
+	 copy (start[k], c[k].gr);
+      }
+      ITEMfree (c[k].grProx);
+   }
+
+   /* Convergence diagnostics. */
+   chainsDiag (c, Nchains, res->ess, res->rhat);
+   for (k = 0; k < Nchains; k++)
+      for (q = 0; q < 2; q++)
+	 DIAGfree (c[k].tr[q]);
+
+   /* Merges the histograms. */
+   res->steps = c[0].steps;
+   res->accept = c[0].accept;
+   res->err = 0;
+   res->marg = marginals ? chainsMarg (c, Nchains) : NULL;
+   for (k = 1; k < Nchains; k++) {
+      res->err += STerrBound (c[k].st);
+      STwalk (c[k].st, mergeGraph, c[0].st);
+      STfree (c[k].st);
+      res->steps += c[k].steps;
+      res->accept += c[k].accept;
+   }
+
+   st = c[0].st;
+   free (acc);
+   free (thr);
+   free (c);
+
+   return st;
+
+} /* mcChains */
+
+
+/* ********************************************************* */
+/* Returns the maximum number of Monte Carlo steps of a run  */
+/* (chosen by the user or given by the available memory).    */
+/* The available memory is split among the 'Nshare' runs     */
+/* whose histograms are kept at the same time.               */
+static unsigned long mcMaxSteps ()
+{
+   if (fixSteps) /* chosen by the user */
+      return MEM;
+
+   /* Depends on the memory available. */
+   return 3 * (MEM / Nshare / (2 * (Nedges + 35)));
+
+} /* mcMaxSteps */
+
+
+/* ********************************************************* */
+/* Computes at 'logPP[0]' and 'logPP[1]' the non-normalized  */
+/* log-posterior probabilities, with and without the penalty */
+/* 'pen', of the graph 'gr' with the "interaction energies"  */
+/* 'Vij'.                                                    */
+static void graphLogPP (Key gr, double pen, double *Vij, double *logPP)
+{
+   int i;
+
+   logPP[0] = logPP[1] = 0.0;
+   for (i = 0; i < Nedges; i++) {
+      /* Non-normalized log-posterior probability (with penalty). */
+      logPP[0] += ITEMelem (gr, i) * (Vij[i] - pen * spkRange);
+      /* Non-normalized log-posterior probability (without penalty). */
+      logPP[1] += ITEMelem (gr, i) * Vij[i];
+   }
+
+} /* graphLogPP */
+
+
+/* ********************************************************* */
+/* Fills the summary 'res' of a run with penalty 'pen' from  */
+/* its symbol-table 'st' and the "interaction energies"      */
+/* 'Vij' (the graph 'res->max' must be freed by the caller). */
+/* The error bound of 'st' is added to 'res->err'. Without   */
+/* symbol-table ('STnone') the graph is the median           */
+/* probability graph, i.e. the graph with the edges whose    */
+/* marginal probabilities 'res->marg' are greater than 1/2.  */
+static void mcSummary (ST st, double pen, double *Vij, resultInfo *res)
+{
+   int i;
+
+   /* *** This might interest you!!! *** */
+   /* For those who do not believe that this program really */
+   /* works please uncomment the following line code. It    */
+   /* will print all distinct graphs at the standard        */
+   /* output, but be aware that it can be a lot of graphs.  */
+   /* STsort (st, stdout, ITEMshow); */
+
+   /* Computes some results. */
+   res->penal = pen;
+   res->total = STtotalCount(st);
+   res->count = STcount(st);
+   res->maxCont = STmaxCont(st);
+   res->err += STerrBound(st);
+   res->max = ITEMnew ();
+   if (stKind == STnone) { /* median probability graph */
+      for (i = 0; i < Nedges; i++)
+	 if (res->marg[i] > 0.5)
+	    ITEMgenerator (res->max, i + 1); /* with edge */
+   }
+   else
+      copy (res->max, STmaxItem(st));
+   graphLogPP (res->max, pen, Vij, res->logPP);
+   /* Empirical probability (obtained from the Monte Carlo). */
+   res->logPP[2] = 1.0*res->maxCont/res->total;
+
+} /* mcSummary */
+
+
+/* ********************************************************* */
+/* Generates a Markov Chain, on an undirected graph space,   */
+/* whose limit distribution is given by the posterior        */
+/* probability 'P(g|X)'. This is done via Monte Carlo method */
+/* with Metropolis algorithm. Receives the "interaction      */
+/* energies" 'Vij', the penalty constant 'pen', the stream  */
+/* 'rng' of the generators of the chains and their starting  */
+/* states 'start' (see 'mcChains'), and fills the summary    */
+/* 'res' of the run (its graph 'res->max' and its            */
+/* probabilities 'res->marg' must be freed by the caller).   */
+/* The graphs module must have been initialized with         */
+/* 'Nedges' elements, so that several runs can be computed   */
+/* at the same time.                                         */
+static void mcmc (double pen, double *Vij, Rng *rng, Key *start,
+		  resultInfo *res)
+{
+   ST st; /* symbol-table of the generated graphs */
+
+   /* Runs the chains and merges their histograms. */
+   res->maxMCsteps = mcMaxSteps ();
+   st = mcChains (Vij, pen, rng, res->maxMCsteps, start, res);
+
+   mcSummary (st, pen, Vij, res);
+   STfree (st);
+
+} /* mcmc */
+
+
+/* ********************************************************* */
+/* Computes, without Monte Carlo, the summary 'res' of the   */
+/* posterior with the "interaction energies" 'Vij' and the   */
+/* penalty constant 'pen' (its graph 'res->max' and its      */
+/* probabilities 'res->marg' must be freed by the caller).   */
+/* As the log-posterior of a graph is the sum of             */
+/* 'x_e = Vij[e] - pen spkRange' over its edges 'e', the     */
+/* posterior is a product of independent edges: each edge is */
+/* in the graph with probability '1 / (1 + exp(-x_e))', the  */
+/* most probable graph has the edges with 'x_e > 0' (it is   */
+/* also the median probability graph) and its normalized     */
+/* probability is the product of 'max {p_e, 1-p_e}'. It      */
+/* takes O(Nedges) time and serves as a reference for the    */
+/* Markov Chain Monte Carlo.                                 */
+static void exactPost (double *Vij, double pen, resultInfo *res)
+{
+   int e;
+   double x, logP = 0.0;
+
+   res->penal = pen;
+   res->maxMCsteps = res->steps = res->accept = 0;
+   res->total = res->maxCont = res->err = 0;
+   res->count = 0;
+   res->ess[0] = res->ess[1] = res->rhat[0] = res->rhat[1] = 0.0;
+   res->max = ITEMnew ();
+   res->marg = UTILmalloc (Nedges * sizeof (double));
+   for (e = 0; e < Nedges; e++) {
+      x = Vij[e] - pen * spkRange;
+      if (x > 0.0) {
+	 ITEMgenerator (res->max, e + 1); /* with edge */
+	 res->marg[e] = 1.0 / (1.0 + exp (-x));
+      }
+      else
+	 res->marg[e] = exp (x) / (1.0 + exp (x));
+      logP -= log1p (exp (-fabs (x)));
+   }
+   graphLogPP (res->max, pen, Vij, res->logPP);
+   res->logPP[2] = exp (logP);
+
+} /* exactPost */
+
+
+/* ********************************************************* */
+/* Computes the Markov Chain Monte Carlo with the penalty    */
+/* constant chosen by the user and writes the general output */
+/* and the adjacency matrix of the most representative graph */
+/* at 'outPath'.                                             */
+static void mcBestGraph (char *outPath, spkInfo *tkt, statsInfo *stats)
+{
+   int length;
+   double *Vij; /* "interaction energy": Vij = Jij * <Xi|Xj> */
+   Rng rng; /* stream of the generators */
+   resultInfo res; /* summary of the run */
+   char *outName; /* file name for general output */
+
+   /* Initializes variables. */
+   Nedges = Nneuron * (Nneuron - 1) / 2; /* # of edges */
+   ITEMinit (Nedges); /* graphs with 'Nedges' elements */
+
+   /* File name for general output. */
+   length = strlen (outPath);
+   outName = UTILmalloc ((length + 35) * sizeof (char));
+   outName[0] = '\0';
+
+   /* Computes all possible "interaction energies". */
+   Vij = gibbsEn (stats);
+
+   /* Checkpoint file of the chains. */
+   if ((ckptPeriod > 0 || resume) && !exact) {
+      ckptName = UTILmalloc ((length + 35) * sizeof (char));
+      sprintf (ckptName, "%sckptM%d%sp%dMet%d.bin",
+	       outPath, rat, region, part, met);
+   }
+
+   /* Markov Chain Monte Carlo (or the exact posterior). */
+   RNGseed (&rng, seed);
+   if (exact)
+      exactPost (Vij, penal, &res);
+   else
+      mcmc (penal, Vij, &rng, NULL, &res);
+
+   /* Writes output data. */
+   sprintf (outName, "%soutputM%d%sp%dMet%d.dat",
+	    outPath, rat, region, part, met);
+   output (outName, &res, tkt);
+
+   /* Output of the adjacency matrix. */
+   outName[0] = '\0';
+   sprintf (outName, "%sadjM%d%sp%dMet%d.dat",
+	    outPath, rat, region, part, met);
+   outputAdjM (outName, res.max, tkt);
+
+   /* Output of the marginal probabilities of the edges. */
+   if (res.marg != NULL) {
+      sprintf (outName, "%smargM%d%sp%dMet%d.dat",
+	       outPath, rat, region, part, met);
+      outputMarg (outName, res.marg, tkt);
+      free (res.marg);
+   }
+
+   /* Frees memory. */
+   ITEMfree (res.max);
+   free (Vij);
+   free (outName);
+   free (ckptName);
+   ckptName = NULL;
+
+} /* mcBestGraph */
+
+
+/* ********************************************************* */
+/* Reads the next spike time of the file 'spkPath' (mapped   */
+/* into memory) from '*p' into 'aux', advancing '*p', and    */
+/* exits the program if there is no valid number left.       */
+static void spkNext (const char **p, const char *end, double *aux,
+		     char *spkPath)
+{
+   int info;
+
+   info = UTILparseDouble (p, end, aux);
+   UTILcheckFscan (info, spkPath); /* end of file */
+   if (info != 1) {
+      fprintf (stderr, "\n Error: Invalid number in the file '%s'!\n\n",
+	       spkPath);
+      exit (EXIT_FAILURE);
+   }
+
+} /* spkNext */
+
+
+/* ********************************************************* */
+/* Receives the text of a file of spikes (from 'buf' to      */
+/* 'end'), whose spike times are increasing, and returns a   */
+/* position such that all spike times before it are smaller  */
+/* than 'min'. It is found by a binary search on the bytes   */
+/* of the file: at each step, the first spike time after the */
+/* middle byte is read and, if it is smaller than 'min', the */
+/* search goes on after it, otherwise before the middle.     */
+static const char *spkSeek (const char *buf, const char *end, double min)
+{
+   const char *lo, *hi, *p;
+   double aux;
+
+   lo = buf;
+   hi = end;
+   while (hi - lo > 64) {
+      p = lo + (hi - lo) / 2;
+
+      /* Skips the (partial) number at the middle. */
+      while (p < hi && *p > ' ')
+	 p++;
+      if (p >= hi || UTILparseDouble (&p, end, &aux) != 1 || aux >= min)
+	 hi = lo + (hi - lo) / 2;
+      else
+	 lo = p; /* all spike times up to 'p' are smaller */
+   }
+
+   return lo;
+
+} /* spkSeek */
+
+
+/* ********************************************************* */
+/* Receives the name of a file containing the observed       */
+/* spikes of a given neuron and the minimum time to be       */
+/* considered. Reads the file and generates a vector of      */
+/* spikes where an element is equal to '1' if there was a    */
+/* spike at a 'Trange' time window after each 'Tstep' time   */
+/* interval or '0' if not. This vector is stored as a bitset */
+/* (see Bits.h), whose last bits are kept as '0', and it is  */
+/* then returned. The file is mapped into memory and its     */
+/* numbers are parsed by 'UTILparseDouble' (which gives the  */
+/* same numbers as 'fscanf'), and the spike times before     */
+/* 'min' are skipped by a binary search.                     */
+static unsigned long *spkRead (char *spkPath, double min)
+{
+   int j, n;
+   long size;
+   unsigned long *tktSPK; /* bitset of spikes */
+   double time, aux;
+   char *buf; /* file with spikes (mapped into memory) */
+   const char *p, *end;
+
+   /* Maps the file with spikes. */
+   buf = UTILmmap (spkPath, &size);
+   p = buf;
+   end = buf + size;
+
+   /* Allocates the bitset of spikes (without spikes). */
+   n = BITSwords (spkRange);
+   tktSPK = UTILmalloc (n * sizeof (unsigned long));
+   for (j = 0; j < n; j++)
+      tktSPK[j] = 0;
+
+   /* Scans the file considering 1 'Trange' window after each 'Tstep'. */
+   aux = 0.0;
+   time = min;
+   if (aux < time)
+      p = spkSeek (buf, end, min); /* skips the spikes before 'min' */
+   for (j = 0; j < spkRange; j++) {
+
+      /* Reads the file until it reaches the next starting point. */
+      while (aux < time)
+	 spkNext (&p, end, &aux, spkPath);
+
+      while (aux < time + Trange) { /* checks if there is a spike */
+	 spkNext (&p, end, &aux, spkPath);
+	 tktSPK[j / BITSword] |= 1UL << (j % BITSword);
+      }
+
+      /* Jumps the 'Tstep' time interval. */
+      time += Tstep * Trange;
+
+   } /* for (j = 0; j < ... */
+   
+   UTILmunmap (buf, size); /* unmaps the file */
+
+   return tktSPK;
+   
+} /* *spkRead */
+
+
+/* ********************************************************* */
+/* Fills the header 'h' and the description 'nr' of each     */
+/* neuron that a cache of the spikes 'tkt' (with minimum     */
+/* time 'min') must have. Returns '0' if some spike file     */
+/* could not be found, or '1' otherwise. The memory is       */
+/* cleared first, so that the headers can be compared byte   */
+/* by byte.                                                  */
+static int cacheFill (cacheHeader *h, cacheNeuron *nr, spkInfo *tkt,
+		      double min)
+{
+   int i;
+   struct stat st;
+
+   memset (h, 0, sizeof *h);
+   memset (nr, 0, Nneuron * sizeof *nr);
+
+   h->magic = CACHEmagic;
+   h->version = CACHEversion;
+   h->wordSize = (int) sizeof (unsigned long);
+   h->mouse = rat;
+   h->part = part;
+   strcpy (h->region, region);
+   h->Nneuron = Nneuron;
+   h->spkRange = spkRange;
+   h->range = Trange;
+   h->step = Tstep;
+   h->min = min;
+
+   for (i = 0; i < Nneuron; i++) {
+      if (stat (tkt[i].path, &st) != 0)
+	 return 0;
+      strcpy (nr[i].label, tkt[i].label);
+      strcpy (nr[i].path, tkt[i].path);
+      nr[i].size = (long) st.st_size;
+      nr[i].mtime = (long) st.st_mtime;
+   }
+
+   return 1;
+
+} /* cacheFill */
+
+
+/* ********************************************************* */
+/* Writes the cache 'cacheName' with the spikes 'tkt' and    */
+/* its header 'h' and neurons 'nr'. The file is written with */
+/* a temporary name and then renamed, so that other runs     */
+/* never see a partial cache. As the cache is only an        */
+/* optimization, nothing is done if it cannot be written.    */
+static void cacheWrite (char *cacheName, cacheHeader *h, cacheNeuron *nr,
+			spkInfo *tkt)
+{
+   int i, n, ok;
+   long pad;
+   char *tmpName;
+   unsigned long zero = 0;
+   FILE *out;
+
+   tmpName = UTILmalloc ((strlen (cacheName) + 25) * sizeof (char));
+   sprintf (tmpName, "%s.%ld", cacheName, (long) getpid ());
+
+   out = fopen (tmpName, "wb");
+   if (out != NULL) {
+      n = BITSwords (spkRange);
+      pad = cacheOffset (Nneuron) - sizeof *h - Nneuron * sizeof *nr;
+      ok = (fwrite (h, sizeof *h, 1, out) == 1);
+      ok = ok && (fwrite (nr, sizeof *nr, Nneuron, out) == Nneuron);
+      ok = ok && (fwrite (&zero, 1, pad, out) == pad);
+      for (i = 0; i < Nneuron && ok; i++)
+	 ok = (fwrite (tkt[i].spikes, sizeof (unsigned long), n, out) == n);
+      ok = (fclose (out) == 0) && ok;
+      if (!ok || rename (tmpName, cacheName) != 0)
+	 remove (tmpName);
+   }
+
+   free (tmpName);
+
+} /* cacheWrite */
+
+
+/* ********************************************************* */
+/* Gets the spikes of all neurons of 'tkt' (whose labels and */
+/* paths to the spike files are already known) with minimum  */
+/* time 'min'. If the cache 'cacheName' has the same header  */
+/* and the spike files have the same sizes and modification  */
+/* times, the cache is mapped into memory ('cache') and the  */
+/* spikes point to its bitsets. Otherwise, the spikes are    */
+/* read from the spike files (see 'spkRead') and the cache   */
+/* is (re)written for the next runs.                         */
+static void spkLoad (char *cacheName, spkInfo *tkt, double min,
+		     cacheInfo *cache)
+{
+   int i, n, ok;
+   cacheHeader h;
+   cacheNeuron *nr;
+   struct stat st;
+
+   n = BITSwords (spkRange);
+   nr = UTILmalloc (Nneuron * sizeof (cacheNeuron));
+   ok = cacheFill (&h, nr, tkt, min);
+   cache->buf = NULL;
+
+   /* Tries the cache. */
+   if (ok && stat (cacheName, &st) == 0 && (long) st.st_size
+       == cacheOffset (Nneuron) + (long) (Nneuron * n * sizeof (unsigned long))) {
+      cache->buf = UTILmmap (cacheName, &cache->size);
+      if (memcmp (cache->buf, &h, sizeof h) != 0
+	  || memcmp (cache->buf + sizeof h, nr, Nneuron * sizeof *nr) != 0) {
+	 UTILmunmap (cache->buf, cache->size);
+	 cache->buf = NULL;
+      }
+   }
+
+   if (cache->buf != NULL) /* the cache is up to date */
+      for (i = 0; i < Nneuron; i++)
+	 tkt[i].spikes = (unsigned long *) (cache->buf + cacheOffset (Nneuron))
+	    + i * n;
+   else {
+      /* Gets the spikes from the files. */
+      for (i = 0; i < Nneuron; i++)
+	 tkt[i].spikes = spkRead (tkt[i].path, min);
+      if (ok)
+	 cacheWrite (cacheName, &h, nr, tkt);
+   }
+
+   free (nr);
+
+} /* spkLoad */
+
+
+/* ********************************************************* */
+/* Frees memory of the stored spikes data (i.e. neuron label */
+/* and its spikes in the time interval considered), or       */
+/* unmaps the cache, if the spikes came from it.             */
+static void spkFree (spkInfo *tkt, cacheInfo *cache)
+{
+   int i;
+
+   if (cache->buf != NULL)
+      UTILmunmap (cache->buf, cache->size);
+   else
+      for (i = 0; i < Nneuron; i++)
+	 free (tkt[i].spikes);
+   free (tkt);
+   
+} /* spkFree */
+
+
+/* ********************************************************* */
+/* Writes the results of the point 'i' of the sweep 's' (the */
+/* lock of the sweep must be held, if there is one) and      */
+/* frees its graph and probabilities. If it is the 11th      */
+/* near-zero result, the remaining points are cut off        */
+/* ('s->cut' is set to 'i+1').                               */
+static void writePoint (sweepInfo *s, int i)
+{
+   resultInfo *res = &s->res[i];
+
+   /* General output. */
+   output (s->outName, res, s->tkt);
+
+   /* Writes results. */
+   fprintf (s->out1, "%.7f  %.10f\n", res->penal, res->logPP[0]);
+   fflush (s->out1); /* print now! */
+   fprintf (s->out2, "%.7f  %.10f\n", res->penal, res->logPP[1]);
+   fflush (s->out2); /* print now! */
+   if (s->out3 != NULL) {
+      fprintf (s->out3, "%.7f  %.10f\n", res->penal, res->logPP[2]);
+      fflush (s->out3); /* print now! */
+   }
+
+   ITEMfree (res->max);
+   res->max = NULL;
+   if (res->marg != NULL) {
+      free (res->marg);
+      res->marg = NULL;
+   }
+
+   /* Just to avoid unnecessary computation. */
+   if (res->logPP[0] < 0.0000001) {
+      s->zeros++;
+      if (s->zeros > 10)
+	 s->cut = i + 1;
+   }
+
+} /* writePoint */
 
 
 /* ********************************************************* */
-/* Sets the penalty constant chosen by the user.             */
-void NEUROsetPenal (char *penalty)
+/* Returns the number of threads of the pool of a sweep that */
+/* computes at most 'n' points at the same time (one for     */
+/* each online processor, if 'Nthreads' is 0). As each point */
+/* keeps its own histogram, they share the available memory  */
+/* (see 'mcMaxSteps').                                       */
+static int sweepThreads (int n)
 {
-   penal = atof (penalty);
+   int threads;
 
-} /* NEUROsetPenal */
+   threads = (Nthreads > 0) ? Nthreads : POOLcores ();
+   if (threads > n)
+      threads = n;
+   Nshare = (threads > 1) ? threads : 1;
 
+   return threads;
 
-/* ********************************************************* */
-/* Prints the adjacency matrix representation of the key     */
-/* 'max' at 'std' file. The key is a graph in vector         */
-/* representation and, in order to maintain the coherence    */
-/* with other parts of the program, the rule is fill the     */
-/* elements below the main diagonal in row-major order.      */
-static void printAdjMatrix (FILE *std, Key max, spkInfo *tkt)
-{
-   int i, j;
-   Key adjMatrix;
+} /* sweepThreads */
 
-   /* Creates the matrix. */
-   adjMatrix = UTILmalloc (Nneuron * Nneuron * sizeof (adjMatrix));
 
-   /* Initializes the matrix with "0s". */
-   for (i = 0; i < Nneuron; i++)
-      for (j = 0; j < Nneuron; j++)
-	 adjMatrix[idx2d(i,j,Nneuron)] = '0';
+/* ********************************************************* */
+/* Task of the pool of a penalty sweep: computes the Markov  */
+/* Chain Monte Carlo of the point 'i' of the sweep 'arg' and */
+/* then writes, in order, all the results that are ready     */
+/* (cancelling the points after the cut, if it is reached).  */
+static void penalPoint (Pool p, int i, void *arg)
+{
+   sweepInfo *s = arg;
 
-   /*  *** This is an important "trick" of the algorithm!! ***  */
-   /* Copies the values of vector 'max' to the symmetric matrix */
-   /* following the rule of filling the elements below the      */
-   /* main diagonal in row-major order. Note that, 'i > j' and  */
-   /* 'idxAdj(i,j)' will give the correct index (see Item.h).   */
-   for (i = 1; i < Nneuron; i++)
-      for (j = 0; j < i; j++) {
-	 adjMatrix[idx2d(i,j,Nneuron)] = max[idxAdj(i,j)];
-	 adjMatrix[idx2d(j,i,Nneuron)] = max[idxAdj(i,j)];
-      }
+   /* Markov Chain Monte Carlo. */
+   mcmc (s->pen[i], s->Vij, &s->rng[i], NULL, &s->res[i]);
 
-   /* Prints the matrix in 'std' file with the   */
-   /* electrodes labels at each column and line. */
-   fprintf (std, "    ");
-   for (i = 0; i < Nneuron; i++)
-      fprintf (std, " %s ", tkt[i].label);
-   fprintf (std, "\n");
-   for (i = 0; i < Nneuron; i++) {
-      fprintf (std, "%s ", tkt[i].label);
-      for (j = 0; j < Nneuron; j++)
-	 fprintf (std, "  %c  ", adjMatrix[idx2d(i,j,Nneuron)]);
-      fprintf (std, "\n");
+   pthread_mutex_lock (&s->lock);
+   s->done[i] = 1;
+   while (s->next < s->cut && s->done[s->next]) {
+      writePoint (s, s->next);
+      s->next++;
    }
+   if (s->cut < s->Npoints)
+      POOLcancel (p, s->cut);
+   pthread_mutex_unlock (&s->lock);
 
-} /* printAdjMatrix */
+} /* penalPoint */
 
 
 /* ********************************************************* */
-/* Receives an output file name 'outName' and prints a lot   */
-/* of relevant information about the run (the code is quite  */
-/* self explanatory).                                        */
-static void output (char *outName, spkInfo *tkt, unsigned long accept,
-		    unsigned long steps, unsigned long maxMCsteps)
+/* Penalty sweep with an independent Markov Chain Monte      */
+/* Carlo at each point of the sweep 's'. The penalty points  */
+/* are computed at the same time by a pool of 'Nthreads'     */
+/* threads (see Pool.h), which share the available memory,   */
+/* but their results are written in order.                   */
+static void penalGrid (sweepInfo *s)
 {
    int i;
-   FILE *out; /* file for general output */
 
-   out = UTILfopen (outName, "a"); /* opens the general output file */
+   pthread_mutex_init (&s->lock, NULL);
 
-   fprintf (out, "** Mouse %d - %s - part %d **\n", rat, region, part);
-   fprintf (out, "\nNumber of neurons: %d", Nneuron);
-   fprintf (out, "\nNeurons labels: ");
-   for (i = 0; i < Nneuron; i++)
-      fprintf (out, " %s ", tkt[i].label);
-   fprintf (out, "\nMC steps: %lu", steps);
-   fprintf (out, "\nMaximum allowed MC steps: %lu", maxMCsteps);
-   fprintf (out, "\nTotal graphs counted: %lu", STtotalCount());
-   fprintf (out, "\nPenalty constant: %.5f", penal);
-   fprintf (out, "\nDistinct graphs: %d", STcount());
+   /* Looping over penalty values. */
+   POOLrun (sweepThreads (s->Npoints), s->Npoints, penalPoint, s);
 
-   /* *** This might interest you!!! *** */
-   /* For those who do not believe that this program really */
-   /* works please uncomment the following line code. It    */
-   /* will print all distinct graphs at the output file,    */
-   /* but be aware that it can be a lot of graphs.          */
-   /* STsort (stdout, ITEMshow); */
-
-   fprintf (out, "\nAccepted graphs: %lu", accept);
-   fprintf (out, "\nMost representative graph counter = %lu", STmaxCont());
-   fprintf (out, "\nMost representative graph probability = %.5f",
-	    1.0*STmaxCont()/(steps + 1));
-   fprintf (out, "\nMost representative graph (vectorial form):\n");
-   STshowMaxItem (out); /* show in vectorial form */
-   fprintf (out, "\nMost representative graph (adjacency matrix):\n");
-   printAdjMatrix (out, STmaxItem(), tkt); /* show adjacency matrix */
-   fprintf (out, "\n\n");
+   /* Frees the graphs of the points computed after the cut. */
+   for (i = s->next; i < s->Npoints; i++)
+      if (s->done[i]) {
+	 ITEMfree (s->res[i].max);
+	 free (s->res[i].marg);
+      }
 
-   fclose (out); /* closes the general output file */
+   pthread_mutex_destroy (&s->lock);
 
-} /* output */
+} /* penalGrid */
 
 
 /* ********************************************************* */
-/* Receives an output file name 'outName' and prints the     */
-/* adjacency matrix of the highest score graph in this file. */
-static void outputAdjM (char *outName, spkInfo *tkt)
+/* Warm penalty sweep: the points of the sweep 's' are       */
+/* computed in order and the chains of each point start from */
+/* the final graphs of the chains of the previous point      */
+/* (whose penalty is close), with a shorter thermalization   */
+/* (see 'mcWarmSteps'). Only the chains of a point run at    */
+/* the same time (see '--chains').                           */
+static void penalWarm (sweepInfo *s)
 {
+   int i, k;
+   Key *start; /* final graphs of the previous point */
+
+   Nshare = 1;
+   start = UTILmalloc (Nchains * sizeof (Key));
+   for (k = 0; k < Nchains; k++)
+      start[k] = NULL; /* the first point starts randomly */
+
+   for (i = 0; i < s->cut; i++) {
+      mcmc (s->pen[i], s->Vij, &s->rng[i], start, &s->res[i]);
+      writePoint (s, i);
+      s->next = i + 1;
+   }
 
-   FILE *out; /* file for adjacency matrix output */
-
-   out = UTILfopen (outName, "w"); /* opens the file */
-   printAdjMatrix (out, STmaxItem(), tkt); /* prints the adjacency matrix */
-   fclose (out); /* closes the file */
+   for (k = 0; k < Nchains; k++)
+      if (start[k] != NULL)
+	 ITEMfree (start[k]);
+   free (start);
 
-} /* outputAdj */
+} /* penalWarm */
 
 
 /* ********************************************************* */
-/* Creates the Monte Carlo starting state randomly (the      */
-/* probability of having each edge is 0.5).                  */
-static Key MCinit ()
+/* Task of the pool of an adaptive sweep: computes the       */
+/* Markov Chain Monte Carlo of the 'k'-th point to be        */
+/* computed of the sweep 'arg'.                              */
+static void adaptPoint (Pool p, int k, void *arg)
 {
-   int i;
-   double u;
-   Key ini;
-
-   /* Allocates the graph. */
-   ini = UTILmalloc ((Nedges + 1) * sizeof (ini));
-
-   /* Decides (randomly) if each possible edge exists. */
-   for (i = 0; i < Nedges; i++) {
-      u =  1.0 * rand() / RAND_MAX; /* pseudo-random u ~ Unif[0,1] */
-      if (u < 0.5) /* probability = 0.5 */
-	 ini[i] = '0'; /* no edge */
-      else
-	 ini[i] = '1'; /* with edge */
-   }
-   ini[i] = '\0'; /* terminating null character */
+   adaptInfo *ad = arg;
+   sweepInfo *s = ad->s;
+   int i = ad->todo[k]; /* point of the sweep */
 
-   return ini;
+   mcmc (s->pen[i], s->Vij, &s->rng[i], NULL, &s->res[i]);
+   s->done[i] = 1;
 
-} /* MCinit */
+} /* adaptPoint */
 
 
 /* ********************************************************* */
-/* Given two observed data 'obs1' and 'obs2', computes their */
-/* their "interaction" according to the method chosen:       */
-/*    1:  <Xi|Xj>=1 if Xi=1 and Xj=1.                        */
-/*    2:  <Xi|Xj>=1 if Xi=Xj or <Xi|Xj>=0 (if Xi!=Xj).       */
-/*    3:  <Xi|Xj>=1 if Xi=Xj=1, <Xi|Xj>=-1 if Xi!=Xj         */
-/*        or <Xi|Xj>=0 if Xi=Xj=0.                           */
-static int gibbsEnMethod (int obs1, int obs2)
+/* Returns '1' if the results of the points 'a' and 'b' of   */
+/* the sweep 's' differ or '0' if not. The 'penal1' value of */
+/* a graph with 'm' edges is the line 'penal2 - pen spkRange */
+/* m' of the penalty, which only depends on the graph, so    */
+/* the gap at 'a' between the line of the graph of 'a' and   */
+/* the line of the graph of 'b' (and the gap at 'b') tells   */
+/* how far the curves are from a single line between the     */
+/* points (the two gaps add up to 'spkRange' times the       */
+/* difference of the penalties times the difference of the   */
+/* numbers of edges). The points differ if their most        */
+/* representative graphs differ and a gap is greater than    */
+/* the tolerance 'adaptTol' (by default 0, so every change   */
+/* of the graph is bisected).                                */
+static int refine (sweepInfo *s, int a, int b)
 {
-   if (met == 1) /* <Xi|Xj>=1 if Xi=1 and Xj=1. */
-      return (obs1 * obs2);
-   if (met == 2) { /* <Xi|Xj>=1 if Xi=Xj or <Xi|Xj>=0 (if Xi!=Xj). */
-      if (obs1 == obs2)
-	 return 1;
-      return 0;
-   }
-   /* <Xi|Xj>=1 if Xi=Xj=1, <Xi|Xj>=-1 if Xi!=Xj */
-   /* or <Xi|Xj>=0 if Xi=Xj=0.                   */
-   if (obs1 == 1 && obs2 == 1)
-      return 1;
-   else if (obs1 != obs2)
-      return -1;
-   return 0;
+   resultInfo *ra = &s->res[a], *rb = &s->res[b];
+   double ga, gb;
 
-} /* gibbsEnMethod */
+   if (eq (ra->max, rb->max))
+      return 0; /* the same line */
+
+   ga = ra->logPP[0] - (rb->logPP[1] - s->pen[a] * spkRange
+			* ITEMcount (rb->max));
+   gb = rb->logPP[0] - (ra->logPP[1] - s->pen[b] * spkRange
+			* ITEMcount (ra->max));
+
+   return fabs (ga) > adaptTol || fabs (gb) > adaptTol;
+
+} /* refine */
 
 
 /* ********************************************************* */
-/* Computes the "interaction energies" between all possible  */
-/* neighbors.                                                */
-static double *gibbsEn (spkInfo *tkt)
+/* Sets the cut of the adaptive sweep 's' 10 points after    */
+/* its first computed near-zero point, where the other       */
+/* sweeps would cut it off (their near-zero points follow    */
+/* each other, as the graph of a greater penalty has no more */
+/* edges).                                                   */
+static void adaptCut (sweepInfo *s)
 {
-   int i, j, k, g;
-   double *Vij;
-
-   /* Allocates the "interaction energy" vector. */
-   Vij = UTILmalloc (Nedges * sizeof (double));
+   int i;
 
-   /*  *** This is an important "trick" of the algorithm!! ***  */
-   /* The index of the "interaction energy" vector must have    */
-   /* the same rule of the graph index when writing the         */
-   /* adjacency matrix. Here this rule is fill the elements     */
-   /* below the main diagonal in row-major order.               */
-   for (g = 0, i = 1; i < Nneuron; i++)
-      for (j = 0; j < i; j++) {
-	  /* Scan the spikes. */
-	 for (Vij[g] = 0.0, k = 0; k < spkRange; k++)
-	    Vij[g] += gibbsEnMethod (tkt[i].spikes[k], tkt[j].spikes[k]);
-	 Vij[++g] *= Jij; /* "interaction energy" between neighbors */
+   for (i = 0; i < s->cut; i++)
+      if (s->done[i] && s->res[i].logPP[0] < 0.0000001) {
+	 if (i + 11 < s->cut)
+	    s->cut = i + 11;
+	 return;
       }
 
-   return Vij;
-
-} /* *gibbsEn */
+} /* adaptCut */
 
 
 /* ********************************************************* */
-/* Receives a candidate for a new state (the changed 'edge') */
-/* and returns '1' if it is accepted or '0' if not. Uses the */
-/* acceptance probability proposed originally by Metropolis  */
-/* et al (1954) with a symmetric sampling kernel ('Qij=Qji') */
-/*           'a(i,j) = min {1, P(g_j|X)/P(g_i|X)}'           */
-/* where 'g_i' is the current state, 'g_j' is the candidate  */
-/* and 'P(g_i|X)' is the posterior probability. It is easy   */
-/* to see that the ratio 'P(g_j|X)/P(g_i|X)}' is given by    */
-/* one of the following options:                             */
-/*   1. 'exp(penal*spkRange-Jij*<Xi|Xj>)' if 'g_j' has one   */
-/*      less edge than 'g_i' (an edge has been removed).     */
-/*   2. 'exp(Jij*<Xi|Xj>-penal*spkRange)' if 'g_j' has one   */
-/*      more edge than 'g_i' (an edge has been inserted).    */
-/* The information about which edge has been changed comes   */
-/* from the integer 'edge': if 'edge<0' it means that an     */
-/* edge has been removed, otherwise an edge has been         */
-/* inserted.                                                 */
-/* Obs.: the addition of '1' in the 'edge' value was         */
-/* necessary to avoid mistake when the index is zero (see    */
-/* 'ITEMrandIdx' function at Item.c).                        */
-static int metropolis (double *gibbsVij, int edge)
+/* Adaptive penalty sweep: only the points of the sweep 's'  */
+/* needed to follow the changes of the results are computed. */
+/* The first points are one out of each 'adaptStride' (and   */
+/* the last one), computed in order, 'Nthreads' at a time,   */
+/* until the cut is reached (see 'adaptCut'). Then, while    */
+/* the results of two neighbouring computed points before    */
+/* the cut differ (see 'refine'), the point halfway between  */
+/* them is computed too, so the transitions of the most      */
+/* representative graph are found by bisection down to the   */
+/* spacing of the sweep. The points of each step are         */
+/* computed at the same time by a pool of 'Nthreads'         */
+/* threads, and the points after the cut are not computed    */
+/* (except those of the step that found it). The computed    */
+/* points are written in order, so the files are the same as */
+/* before, only with a non-uniform penalty spacing.          */
+static void penalAdapt (sweepInfo *s)
 {
-   double u;
+   int a, b, i, k, Ncoarse, threads, n = s->Npoints;
+   int *coarse, *todo; /* coarse and refined points */
+   adaptInfo ad;
+
+   threads = sweepThreads (n);
+   ad.s = s;
+   coarse = UTILmalloc (n * sizeof (int));
+   todo = UTILmalloc (n * sizeof (int));
+
+   /* Coarse points (in order, up to the cut). */
+   for (Ncoarse = 0, i = 0; i < n; i += adaptStride)
+      coarse[Ncoarse++] = i;
+   if ((n - 1) % adaptStride != 0)
+      coarse[Ncoarse++] = n - 1;
+   for (k = 0; k < Ncoarse && coarse[k] < s->cut; k += ad.Ntodo) {
+      ad.todo = coarse + k;
+      ad.Ntodo = 0;
+      while (ad.Ntodo < threads && k + ad.Ntodo < Ncoarse
+	     && coarse[k+ad.Ntodo] < s->cut)
+	 ad.Ntodo++;
+      POOLrun (threads, ad.Ntodo, adaptPoint, &ad);
+      adaptCut (s);
+   }
 
-   /* Generates u ~ Unif[0,1]. */
-   u = 1.0 * rand() / RAND_MAX;
+   /* Refines the points, until the neighbouring ones agree. */
+   ad.todo = todo;
+   do {
+      ad.Ntodo = 0;
+      for (a = 0, b = 1; b < s->cut; b++)
+	 if (s->done[b]) {
+	    if (b - a > 1 && refine (s, a, b))
+	       ad.todo[ad.Ntodo++] = (a + b) / 2;
+	    a = b;
+	 }
+      POOLrun (threads, ad.Ntodo, adaptPoint, &ad);
+      adaptCut (s);
+   } while (ad.Ntodo > 0);
+
+   /* Writes the results in order (up to the cut). */
+   for (i = 0; i < n; i++)
+      if (s->done[i]) {
+	 if (i < s->cut) {
+	    writePoint (s, i);
+	    s->next = i + 1;
+	 }
+	 else {
+	    ITEMfree (s->res[i].max);
+	    free (s->res[i].marg);
+	 }
+      }
 
-   /* An edge has been removed. */
-   if (edge < 0) {
-      if (exp (penal * spkRange - gibbsVij[-edge-1]) > u)
-	 return 1; /* candidate accepted */
-   }
-   else { /* An edge has been inserted. */
-      if (exp (gibbsVij[edge-1] - penal * spkRange) > u)
-	 return 1; /* candidate accepted */
-   }
-   return 0; /* candidate rejected */
+   free (coarse);
+   free (todo);
 
-} /* metropolis */
+} /* penalAdapt */
 
 
 /* ********************************************************* */
-/* Given an initial state 'gr', it computes 'Nsteps' Monte   */
-/* Carlo steps without including the generated graphs into   */
-/* the accepted graphs list. This "thermalization steps" are */
-/* used reduce the importance of choosing the initial state. */
-/* After all the steps, the resulting graph 'gr' is taken as */
-/* the initial state of the Monte Carlo.                     */
-static void mcThermSteps (double *gibbsVij, Key gr)
+/* Penalty sweep with the exact posterior (see 'exactPost')  */
+/* at each point of the sweep 's', written in order (up to   */
+/* the cut).                                                 */
+static void penalExact (sweepInfo *s)
 {
    int i;
-   int edge;
 
-   /* 'Nsteps' Monte Carlo steps. */
-   for (i = 0; i < Nsteps; i++) {
+   for (i = 0; i < s->cut; i++) {
+      exactPost (s->Vij, s->pen[i], &s->res[i]);
+      writePoint (s, i);
+      s->next = i + 1;
+   }
 
-      /* Chooses a random edge to change. */
-      edge = ITEMrandIdx (gr);
+} /* penalExact */
 
-      /* metropolis = 1 if the candidate is accepted. */
-      if (metropolis (gibbsVij, edge) == 1) {
-	 
-	 /* Changes the edge. */
-	 if (edge >= 0)
-	    gr[edge-1] = '1'; /* inserts the edge */
-	 else
-	    gr[-edge-1] = '0'; /* removes the edge */
 
-      }
+/* ********************************************************* */
+/* Task of the pool of a replica exchange run: computes      */
+/* 'Nswap' Monte Carlo steps of the replica 'i' of the       */
+/* vector of chains 'arg'.                                   */
+static void replicaSteps (Pool p, int i, void *arg)
+{
+   chainInfo *c = (chainInfo *) arg + i;
 
-   } /* for (i = 0; i ... */
+   c->accept += mcSteps (c, Nswap);
 
-} /* mcThermSteps */
+} /* replicaSteps */
 
 
 /* ********************************************************* */
-/* Given an initial state 'gr', it computes 'Nsteps' Monte   */
-/* Carlo steps. Each accepted state is included into the     */
-/* accepted graphs list (skip list symbol-table - see ST.c). */
-/* Returns the number of accepted graphs.                    */
-static int mcSteps (double *gibbsVij, Key *gr)
+/* Proposes to exchange the current graphs of the replicas   */
+/* 'a' and 'b' and returns '1' if it is accepted or '0' if   */
+/* not. As the "interaction energies" are the same for both  */
+/* replicas, the Metropolis acceptance probability           */
+/*   'min {1, P_a(g_b|X) P_b(g_a|X) / P_a(g_a|X) P_b(g_b|X)}' */
+/* only depends on the penalties and on the number of edges: */
+/*   'min {1, exp(spkRange (pen_a-pen_b) (|g_a|-|g_b|))}'.   */
+/* The new graph of each replica is added to its             */
+/* symbol-table with counter 0 (it is counted by the next    */
+/* step, as any other state) and the inclusion counters of   */
+/* the edges of both replicas are brought up to date before  */
+/* their graphs change (see 'margFlush').                    */
+static int exchange (chainInfo *a, chainInfo *b)
 {
-   int i;
-   int accept; /* # of accepted graphs */
-   int edge; /* index of the changed edge */
-   Item item; /* skip list object */
-   Key grProx; /* candidate graph */
-
-   /* 'Nsteps' Monte Carlo steps. */
-   for (accept = 0, i = 0; i < Nsteps; i++) {
+   double x;
 
-      /* Chooses a random edge to change. */
-      edge = ITEMrandIdx (*gr);
+   x = 1.0 * spkRange * (a->penal - b->penal)
+      * (ITEMcount (a->gr) - ITEMcount (b->gr));
+   if (exp (x) <= RNGunif (&a->rng))
+      return 0; /* rejected */
 
-      /* metropolis = 1 if the candidate is accepted. */
-      if (metropolis (gibbsVij, edge) == 1) {
+   if (a->incl != NULL) { /* marginal probabilities */
+      margFlush (a);
+      margFlush (b);
+   }
+   copy (a->grProx, b->gr);
+   copy (b->grProx, a->gr);
+   a->cur = STaddRef (a->st, a->grProx, 0);
+   b->cur = STaddRef (b->st, b->grProx, 0);
+   a->gr = STrefItem (a->st, a->cur);
+   b->gr = STrefItem (b->st, b->cur);
+   chainValues (a);
+   chainValues (b);
 
-	 accept++; /* one more graph */
+   return 1; /* accepted */
 
-	 /* Allocates memory for the new graph. */
-	 grProx = UTILmalloc ((Nedges + 1 ) * sizeof (grProx));
-	 copy (grProx, *gr); /* grProx = *gr*/
-	 ITEMgenerator (grProx, edge); /* changes the edge */
+} /* exchange */
 
-	 /* Searches for 'grProx' at graphs list. Returns its   */
-	 /* pointer and increments its counter if it was found, */
-	 /* otherwise returns 'NULLitem' (see ST.c).            */
-	 *gr = STsearch(grProx);
 
-	 if (*gr == NULLitem) { /* there is no grProx at graphs list */
-	    key(item) = grProx;
-	    STinsert (item); /* adds to the list */
-	    *gr = grProx; /* grProx is the current state */
-	 }
-	 else /* grProx exists already at graphs list */
-	    free (grProx);
+/* ********************************************************* */
+/* Penalty sweep via replica exchange (parallel tempering):  */
+/* there is one chain (replica) for each point of the sweep  */
+/* 's', all of them run at the same time (by a pool of       */
+/* 'Nthreads' threads) and, after each 'Nswap' steps, it is  */
+/* proposed to exchange the graphs of neighbouring replicas  */
+/* (alternating the even and the odd pairs). The swaps keep  */
+/* the posterior of each replica as its limit distribution,  */
+/* while the graphs found at a penalty can move to the       */
+/* others. Each replica has its own histogram, whose results */
+/* are written in order as in the independent sweep, and the */
+/* acceptance rate of the swaps between each pair of         */
+/* written neighbouring points is written at 'swapM...dat'.  */
+/* As all replicas are kept at the same time, the available  */
+/* memory is split among them (see 'mcMaxSteps') and the     */
+/* program exits if it is not enough for 'Nswap' steps each. */
+static void penalPT (char *outPath, sweepInfo *s)
+{
+   int i, n, threads;
+   unsigned long r, rounds;
+   unsigned long *tried, *swaps; /* swaps of the pair (i, i+1) */
+   chainInfo *c; /* replicas */
+   char *outName;
+   FILE *out;
+
+   n = s->Npoints;
+   threads = sweepThreads (n);
+   Nshare = n; /* all replicas are in memory */
+   if (mcMaxSteps () < Nswap) {
+      fprintf (stderr, "\n Error: the available memory is not enough for"
+	       " %d replicas!\n\n", n);
+      exit (EXIT_FAILURE);
+   }
+   rounds = (mcMaxSteps () + Nswap - 1) / Nswap;
+
+   /* Initializes the replicas. */
+   c = UTILmalloc ((n + 1) * sizeof (chainInfo));
+   tried = UTILmalloc ((n + 1) * sizeof (unsigned long));
+   swaps = UTILmalloc ((n + 1) * sizeof (unsigned long));
+   for (i = 0; i < n; i++) {
+      c[i].acc = accTable (s->Vij, s->pen[i]);
+      c[i].thr = (kernel == KERNELgibbs) ? gibbsTable (s->Vij, s->pen[i])
+	 : NULL;
+      c[i].Vij = s->Vij;
+      c[i].penal = s->pen[i];
+      c[i].steps = rounds * Nswap;
+      c[i].rng = s->rng[i];
+      c[i].start = NULL;
+      tried[i] = swaps[i] = 0;
+   }
+   POOLrun (threads, n, chainStart, c);
+
+   /* Monte Carlo steps and exchanges. */
+   for (r = 0; r < rounds; r++) {
+      POOLrun (threads, n, replicaSteps, c);
+      for (i = r % 2; i + 1 < n; i += 2) {
+	 tried[i]++;
+	 swaps[i] += exchange (&c[i], &c[i+1]);
+      }
+   }
 
+   /* Writes the results in order (up to the cut). */
+   for (i = 0; i < n; i++) {
+      if (i < s->cut) {
+	 s->res[i].err = 0;
+	 chainsDiag (&c[i], 1, s->res[i].ess, s->res[i].rhat);
+	 s->res[i].marg = marginals ? chainsMarg (&c[i], 1) : NULL;
+	 mcSummary (c[i].st, c[i].penal, s->Vij, &s->res[i]);
+	 s->res[i].maxMCsteps = mcMaxSteps ();
+	 s->res[i].steps = c[i].steps;
+	 s->res[i].accept = c[i].accept;
+	 writePoint (s, i);
+	 s->next = i + 1;
       }
-      else /* candidate rejected */
-	 *gr = STsearch(*gr); /* increments 'gr' counter */
+      else if (marginals) {
+	 free (c[i].incl);
+	 free (c[i].since);
+      }
+      DIAGfree (c[i].tr[0]);
+      DIAGfree (c[i].tr[1]);
+      STfree (c[i].st);
+      ITEMfree (c[i].grProx);
+      free (c[i].acc);
+      free (c[i].thr);
+   }
 
-   } /* for (i = 0; i ... */
+   /* Writes the acceptance rates of the exchanges. */
+   outName = UTILmalloc ((strlen (outPath) + 26) * sizeof (char));
+   sprintf (outName, "%sswapM%d%sp%dMet%d.dat",
+	    outPath, rat, region, part, met);
+   out = UTILfopen (outName, "w");
+   for (i = 0; i + 1 < s->next; i++)
+      fprintf (out, "%.7f  %.7f  %.10f\n", c[i].penal, c[i+1].penal,
+	       (tried[i] > 0) ? 1.0 * swaps[i] / tried[i] : 0.0);
+   fclose (out);
 
-   return accept;
+   /* Frees memory. */
+   free (outName);
+   free (tried);
+   free (swaps);
+   free (c);
 
-} /* mcSteps */
+} /* penalPT */
 
 
 /* ********************************************************* */
-/* Generates a Markov Chain, on an undirected graph space,   */
-/* whose limit distribution is given by the posterior        */
-/* probability 'P(g|X)'. This is done via Monte Carlo method */
-/* with Metropolis algorithm.                                */
-static void mcmc (int type, char *outPath, spkInfo *tkt, double *logPP)
+/* Adds the counter 'cont' of the graph 'item' to the        */
+/* histogram 'H' of the number of edges.                     */
+static void edgesGraph (Item item, unsigned long cont, void *H)
 {
-   int i, length;
-   unsigned long steps, accept; /* MC steps counter, # accepted graphs */
-   Item item; /* skip list object */
-   Key gr; /* current graph */
-   double *Vij; /* "interaction energy": Vij = Jij * <Xi|Xj> */
-   unsigned long maxMCsteps; /* maximum MC steps */
-   char *outName; /* file name for general output */
+   ((double *) H)[ITEMcount (item)] += cont;
 
-   /* Initializes variables. */
-   Nedges = Nneuron * (Nneuron - 1) / 2; /* # of edges */
-   gr = MCinit (); /* first graph generated randomly */
+} /* edgesGraph */
 
-   /* File name for general output. */
-   length = size (outPath);
-   outName = UTILmalloc ((length + 35) * sizeof (char));
-   outName[0] = '\0';
 
-   /* Maximum Monte Carlo steps. */
-   if (fixSteps) /* chosen by the user */
-      maxMCsteps = MEM;
-   else /* depends on the memory available */
-      maxMCsteps = 3 * (MEM / (2 * (Nedges + 35)));
+/* ********************************************************* */
+/* Task of the pool of a reweighted sweep: computes the      */
+/* Markov Chain Monte Carlo of the 'k'-th point to be        */
+/* computed of the sweep 'arg' (a new anchor) and the        */
+/* histogram of the number of edges of its graphs.           */
+static void anchorRun (Pool p, int k, void *arg)
+{
+   int m;
+   reweightInfo *rw = arg;
+   sweepInfo *s = rw->s;
+   int i = rw->todo[k]; /* point of the sweep */
 
-   /* Computes all possible "interaction energies". */
-   Vij = gibbsEn (tkt);
+   s->res[i].maxMCsteps = mcMaxSteps ();
+   rw->st[i] = mcChains (s->Vij, s->pen[i], &s->rng[i],
+			 s->res[i].maxMCsteps, NULL, &s->res[i]);
+   mcSummary (rw->st[i], s->pen[i], s->Vij, &s->res[i]);
+   rw->Ha[i] = UTILmalloc ((Nedges + 1) * sizeof (double));
+   for (m = 0; m <= Nedges; m++)
+      rw->Ha[i][m] = 0.0;
+   STwalk (rw->st[i], edgesGraph, rw->Ha[i]);
 
-   /* "Thermalization" steps. */
-   mcThermSteps (Vij, gr);
+} /* anchorRun */
 
-   /* Creates and initializes the skip list. */
-   key(item) = gr;
-   STinit (); /* creates the skip list */
-   STinsert (item); /* insert 'gr' in the skip list */
-   accept = 1; /* # of accepted graphs */
 
-   /* Monte Carlo steps. */
-   for (steps = 0; steps < maxMCsteps; steps += Nsteps)
-      accept += mcSteps (Vij, &gr);
+/* ********************************************************* */
+/* Returns '1' if the histograms of the number of edges of   */
+/* the anchors 'a' and 'b' of the sweep 'rw' overlap enough  */
+/* to be combined (the sum over 'm' of the smallest of their */
+/* frequencies is at least 'WHAMoverlap') or '0' if not.     */
+static int overlap (reweightInfo *rw, int a, int b)
+{
+   int m;
+   double fa, fb, o = 0.0;
+
+   for (m = 0; m <= Nedges; m++) {
+      fa = rw->Ha[a][m] / rw->s->res[a].total;
+      fb = rw->Ha[b][m] / rw->s->res[b].total;
+      o += (fa < fb) ? fa : fb;
+   }
 
-   /* Computes some results. */
-   if (type == 0) { /* 'penalty analysis' run */
-      logPP[0] = logPP[1] = logPP[2] = 0.0;
-      gr = STmaxItem();
-      for (i = 0; i < Nedges; i++) {
-	 /* Non-normalized log-posterior probability (with penalty). */
-	 logPP[0] += (gr[i] - '0') * (Vij[i] - penal * spkRange);
-	 /* Non-normalized log-posterior probability (without penalty). */
-	 logPP[1] += (gr[i] - '0') * Vij[i];
-      }
-      /* Empirical probability (obtained from the Monte Carlo). */
-      logPP[2] = 1.0*STmaxCont()/(steps + 1);
+   return (o >= WHAMoverlap);
 
-      /* Writes output data. */
-      sprintf (outName, "%soutputM%d%sp%dMet%d.dat",
-	       outPath, rat, region, part, met);
-      output (outName, tkt, accept, steps, maxMCsteps);
+} /* overlap */
 
-      /* /\* Output of the adjacency matrix. *\/ */
-      /* outName[0] = '\0'; */
-      /* sprintf (outName, "%sadjM%d%sp%dMet%dPen%.5f.dat", */
-      /* 	       outPath, rat, region, part, met, penal); */
-      /* outputAdjM (outName, tkt); */
 
-      /* Frees memory. */
-      free (Vij);
-      STfree ();
-      free (outName);
+/* ********************************************************* */
+/* Keeps the graph 'item' as the most visited graph of its   */
+/* class at 'arg' if its counter 'cont' is the greatest one. */
+static void classGraph (Item item, unsigned long cont, void *arg)
+{
+   classInfo *cl = arg;
+   int m = ITEMcount (item);
 
+   if (cl->best[m] == NULL || cont > cl->cont[m]) {
+      cl->cont[m] = cont;
+      cl->best[m] = key (item);
    }
-   else { /* 'best graph' run */
-      /* Writes output data. */
-      sprintf (outName, "%soutputM%d%sp%dMet%d.dat",
-	       outPath, rat, region, part, met);
-      output (outName, tkt, accept, steps, maxMCsteps);
 
-      /* Output of the adjacency matrix. */
-      outName[0] = '\0';
-      sprintf (outName, "%sadjM%d%sp%dMet%d.dat",
-	       outPath, rat, region, part, met);
-      outputAdjM (outName, tkt);
+} /* classGraph */
 
-      /* Frees memory. */
-      free (Vij);
-      STfree ();
-      free (outName);
-   }
 
-} /* mcmc */
+/* ********************************************************* */
+/* Returns 'log (exp (x) + exp (y))' without overflows.      */
+static double logAdd (double x, double y)
+{
+   if (x == -HUGE_VAL)
+      return y;
+   if (y == -HUGE_VAL)
+      return x;
+   if (x > y)
+      return x + log1p (exp (y - x));
+
+   return y + log1p (exp (x - y));
+
+} /* logAdd */
 
 
 /* ********************************************************* */
-/* Receives the name of a file containing the observed       */
-/* spikes of a given neuron and the minimum time to be       */
-/* considered. Reads the file and generates a vector of      */
-/* spikes where an element is equal to '1' if there was a    */
-/* spike at a 'Trange' time window after each 'Tstep' time   */
-/* interval or '0' if not. This vector is then returned.     */
-static int *spkRead (char *spkPath, double min)
+/* Returns the logarithm of the normalization constant of    */
+/* the penalty 'pen' from the histogram 'H' and the          */
+/* "density of states" 'lnOmega' of the number of edges.     */
+static double lnZpen (double *H, double *lnOmega, double pen)
 {
-   int j;
-   int *tktSPK; /* vector of spikes */
-   double time, aux;
-   FILE *spk; /* file with spikes */
+   int m;
+   double z = -HUGE_VAL;
 
-   /* Opens the file with spikes. */
-   spk = UTILfopen (spkPath, "r");
+   for (m = 0; m <= Nedges; m++)
+      if (H[m] > 0.0)
+	 z = logAdd (z, lnOmega[m] - pen * spkRange * m);
 
-   /* Allocates the vector of spikes. */
-   tktSPK = UTILmalloc (spkRange * sizeof (int));
+   return z;
 
-   /* Scans the file considering 1 'Trange' window after each 'Tstep'. */
-   aux = 0.0;
-   time = min;
-   for (j = 0; j < spkRange; j++) {
+} /* lnZpen */
 
-      /* Reads the file until it reaches the next starting point. */
-      while (aux < time)
-	 UTILcheckFscan (fscanf (spk, "%lf", &aux), spkPath);
 
-      tktSPK[j] = 0;
-      while (aux < time + Trange) { /* checks if there is a spike */
-	 UTILcheckFscan (fscanf (spk, "%lf", &aux), spkPath);
-	 tktSPK[j] = 1;
+/* ********************************************************* */
+/* Solves the equations of the multiple histogram method     */
+/* (WHAM) for the anchors 'first' to 'last' of the sweep     */
+/* 'rw', whose histograms of the number of edges sum up to   */
+/* 'H'. As the penalty only multiplies the number of edges   */
+/* 'm' of a graph, the histograms only have to be combined   */
+/* over 'm':                                                 */
+/*   Omega(m) = H(m) / sum_a n_a exp(-pen_a spkRange m)/Z_a  */
+/*   Z_a = sum_m Omega(m) exp(-pen_a spkRange m)             */
+/* where 'n_a' is the number of counted graphs of the anchor */
+/* 'a' and 'Omega(m)' is the "density of states" (the sum of */
+/* the posterior weights without penalty of the graphs with  */
+/* 'm' edges, up to a constant). They are iterated, in       */
+/* logarithms at 'lnOmega' and 'lnZ' (indexed by point),     */
+/* until 'lnZ' changes less than 'WHAMtol' (relative).       */
+static void wham (reweightInfo *rw, int first, int last, double *H,
+		  double *lnOmega, double *lnZ)
+{
+   int a, p, m, it;
+   double x, z, w, d;
+   sweepInfo *s = rw->s;
+
+   /* Initial guess: each anchor stitched to the previous one */
+   /* 'p' over the numbers of edges of both, where            */
+   /* 'H_a(m) Z_a exp(pen_a spkRange m) / n_a' is the same.   */
+   for (p = -1, a = first; a <= last; a++)
+      if (rw->Ha[a] != NULL) {
+	 lnZ[a] = 0.0;
+	 if (p >= 0) {
+	    for (x = w = 0.0, m = 0; m <= Nedges; m++)
+	       if (rw->Ha[p][m] > 0.0 && rw->Ha[a][m] > 0.0) {
+		  z = (rw->Ha[p][m] < rw->Ha[a][m]) ?
+		     rw->Ha[p][m] : rw->Ha[a][m];
+		  x += z * (log (rw->Ha[p][m] / s->res[p].total)
+			    - log (rw->Ha[a][m] / s->res[a].total)
+			    + (s->pen[p] - s->pen[a]) * spkRange * m);
+		  w += z;
+	       }
+	    lnZ[a] = lnZ[p] + x / w;
+	 }
+	 p = a;
       }
 
-      /* Jumps the 'Tstep' time interval. */
-      time += Tstep * Trange;
+   for (d = HUGE_VAL, it = 0; d > WHAMtol && it < WHAMiter; it++) {
+
+      /* Densities of states. */
+      for (m = 0; m <= Nedges; m++)
+	 if (H[m] > 0.0) {
+	    x = -HUGE_VAL;
+	    for (a = first; a <= last; a++)
+	       if (rw->Ha[a] != NULL)
+		  x = logAdd (x, log (rw->s->res[a].total)
+			      - s->pen[a] * spkRange * m - lnZ[a]);
+	    lnOmega[m] = log (H[m]) - x;
+	 }
 
-   } /* for (j = 0; j < ... */
-   
-   fclose (spk); /* closes the file */
+      /* Normalization constants (relative to the first anchor). */
+      x = lnZpen (H, lnOmega, s->pen[first]);
+      for (d = 0.0, a = first; a <= last; a++)
+	 if (rw->Ha[a] != NULL) {
+	    z = lnZpen (H, lnOmega, s->pen[a]) - x;
+	    if (fabs (z - lnZ[a]) > d * (1.0 + fabs (z)))
+	       d = fabs (z - lnZ[a]) / (1.0 + fabs (z));
+	    lnZ[a] = z;
+	 }
+   }
 
-   return tktSPK;
-   
-} /* *spkRead */
+   if (d > WHAMtol)
+      fprintf (stderr, "\n Warning: the reweighting did not converge!\n");
+
+} /* wham */
 
 
 /* ********************************************************* */
-/* Frees memory of the stored spikes data (i.e. neuron label */
-/* and its spikes in the time interval considered).          */
-static void spkFree (spkInfo *tkt)
+/* Penalty sweep via histogram reweighting: only some points */
+/* of the sweep 's' (the anchors) are computed, at the same  */
+/* time by a pool of 'Nthreads' threads, and their           */
+/* histograms are combined (see 'wham') to estimate the      */
+/* posterior at every point. The first anchors are           */
+/* 'Nanchors' points evenly spaced (with the first and the   */
+/* last ones) and, while the histograms of the number of     */
+/* edges of two neighbouring anchors do not overlap (see     */
+/* 'overlap'), the point halfway between them becomes a new  */
+/* anchor. Each run of overlapping anchors is then combined  */
+/* on its own (neighbouring runs are at neighbouring points, */
+/* so every point is in a single run). At a penalty 'pen',   */
+/* the probability of a graph with 'm' edges is its share of */
+/* the counters of all graphs with 'm' edges (which does not */
+/* depend on the penalty) times 'P(m) = Omega(m)             */
+/* exp(-pen spkRange m)/Z(pen)', so the most representative  */
+/* graph is the most visited graph 'best[m]' of one of the   */
+/* classes. The standard error of its probability 'p' is     */
+/* estimated as 'sqrt (p (1-p) / neff)', where 'neff' is the */
+/* effective sample size of the reweighted histograms: the   */
+/* Kish size '1 / sum_m P(m)^2 / H(m)' times the fraction    */
+/* 'ESS/n' of the number of edges at the anchors. The        */
+/* general output has the runs of the anchors, the 'penal'   */
+/* files have all points (up to the cut) and the estimates,  */
+/* their standard errors and 'neff' are written at           */
+/* 'reweightM...dat'.                                        */
+static void penalReweight (char *outPath, sweepInfo *s)
 {
-   int i;
+   int a, b, i, m, mBest, threads, A, n = s->Npoints;
+   double ess, total, lnZi, P, p, pBest, kish, neff;
+   double logPP[2];
+   double *Hall; /* counters of all graphs with 'm' edges */
+   double *H, *lnOmega, *lnZ; /* reweighting of a run of anchors */
+   classInfo cl;
+   reweightInfo rw;
+   char *outName;
+   FILE *out;
+
+   threads = sweepThreads (n);
+   A = (Nanchors > n) ? n : Nanchors; /* first anchors */
+
+   /* Initializes the sweep. */
+   rw.s = s;
+   rw.todo = UTILmalloc (n * sizeof (int));
+   rw.st = UTILmalloc (n * sizeof (ST));
+   rw.Ha = UTILmalloc (n * sizeof (double *));
+   rw.all = STinit (stKind, topK);
+   for (i = 0; i < n; i++)
+      rw.Ha[i] = NULL;
+   for (rw.Ntodo = 0; rw.Ntodo < A; rw.Ntodo++)
+      rw.todo[rw.Ntodo] = (n > 1) ? (int) ((double) rw.Ntodo * (n - 1)
+					   / (A - 1) + 0.5) : 0;
+
+   /* Computes the anchors, until the neighbouring ones overlap. */
+   while (rw.Ntodo > 0) {
+      POOLrun (threads, rw.Ntodo, anchorRun, &rw);
+      for (i = 0; i < rw.Ntodo; i++) {
+	 STwalk (rw.st[rw.todo[i]], mergeGraph, rw.all);
+	 STfree (rw.st[rw.todo[i]]);
+      }
+      rw.Ntodo = 0;
+      for (a = 0, b = 1; b < n; b++)
+	 if (rw.Ha[b] != NULL) {
+	    if (b - a > 1 && !overlap (&rw, a, b))
+	       rw.todo[rw.Ntodo++] = (a + b) / 2;
+	    a = b;
+	 }
+   }
 
-   for (i = 0; i < Nneuron; i++)
-      free (tkt[i].spikes);
-   free (tkt);
-   
-} /* spkFree */
+   /* Classes of the graphs by their number of edges. */
+   Hall = UTILmalloc ((Nedges + 1) * sizeof (double));
+   H = UTILmalloc ((Nedges + 1) * sizeof (double));
+   lnOmega = UTILmalloc ((Nedges + 1) * sizeof (double));
+   lnZ = UTILmalloc (n * sizeof (double));
+   cl.cont = UTILmalloc ((Nedges + 1) * sizeof (unsigned long));
+   cl.best = UTILmalloc ((Nedges + 1) * sizeof (Key));
+   for (m = 0; m <= Nedges; m++) {
+      Hall[m] = 0.0;
+      cl.cont[m] = 0;
+      cl.best[m] = NULL;
+   }
+   STwalk (rw.all, classGraph, &cl);
+   STwalk (rw.all, edgesGraph, Hall);
+
+   /* Reweights each run of overlapping anchors, from 'a' to 'b'. */
+   outName = UTILmalloc ((strlen (outPath) + 30) * sizeof (char));
+   sprintf (outName, "%sreweightM%d%sp%dMet%d.dat",
+	    outPath, rat, region, part, met);
+   out = UTILfopen (outName, "w");
+   for (a = 0; a < s->cut; a = b + 1) {
+      for (m = 0; m <= Nedges; m++)
+	 H[m] = 0.0;
+      ess = total = 0.0;
+      for (b = a, i = a; i < n; i++)
+	 if (rw.Ha[i] != NULL) {
+	    if (i > b && !overlap (&rw, b, i))
+	       break; /* next run */
+	    for (m = 0; m <= Nedges; m++)
+	       H[m] += rw.Ha[i][m];
+	    ess += s->res[i].ess[0];
+	    total += s->res[i].total;
+	    b = i;
+	 }
+      wham (&rw, a, b, H, lnOmega, lnZ);
+
+      /* Most representative graph of each point of the run. */
+      for (i = a; i <= b && i < s->cut; i++) {
+	 lnZi = lnZpen (H, lnOmega, s->pen[i]);
+	 pBest = kish = 0.0;
+	 mBest = 0;
+	 for (m = 0; m <= Nedges; m++)
+	    if (H[m] > 0.0) {
+	       P = exp (lnOmega[m] - s->pen[i] * spkRange * m - lnZi);
+	       kish += P * P / H[m];
+	       p = P * cl.cont[m] / Hall[m];
+	       if (p > pBest) {
+		  pBest = p;
+		  mBest = m;
+	       }
+	    }
+	 neff = (ess > 0.0) ? ess / total / kish : 1.0 / kish;
+	 graphLogPP (cl.best[mBest], s->pen[i], s->Vij, logPP);
+
+	 fprintf (s->out1, "%.7f  %.10f\n", s->pen[i], logPP[0]);
+	 fprintf (s->out2, "%.7f  %.10f\n", s->pen[i], logPP[1]);
+	 fprintf (s->out3, "%.7f  %.10f\n", s->pen[i], pBest);
+	 fprintf (out, "%.7f  %.10f  %.10f  %.2f\n", s->pen[i], pBest,
+		  sqrt (pBest * (1.0 - pBest) / neff), neff);
+
+	 /* Just to avoid unnecessary computation. */
+	 if (logPP[0] < 0.0000001) {
+	    s->zeros++;
+	    if (s->zeros > 10)
+	       s->cut = i + 1;
+	 }
+      }
+   }
+   fclose (out);
+
+   /* General output of the anchors (up to the cut). */
+   for (i = 0; i < n; i++)
+      if (rw.Ha[i] != NULL) {
+	 if (i < s->cut)
+	    output (s->outName, &s->res[i], s->tkt);
+	 ITEMfree (s->res[i].max);
+	 free (s->res[i].marg);
+	 free (rw.Ha[i]);
+      }
+   s->next = s->cut;
+
+   /* Frees memory. */
+   STfree (rw.all);
+   free (outName);
+   free (Hall);
+   free (H);
+   free (lnOmega);
+   free (lnZ);
+   free (cl.cont);
+   free (cl.best);
+   free (rw.todo);
+   free (rw.st);
+   free (rw.Ha);
+
+} /* penalReweight */
 
 
 /* ********************************************************* */
@@ -601,79 +3121,116 @@ static void spkFree (spkInfo *tkt)
 /* 3) for computing the posterior probability. It receives a */
 /* path 'outPath' for writing the output files, the penalty  */
 /* interval ('ini' to 'end') to be considered and the rate   */
-/* of change of the penalty. Creates 3 files containing the  */
-/* penalty value versus:                                     */
+/* of change of the penalty. The sweep is computed, as       */
+/* chosen by 'sweepKind' (see 'NEUROsetSweep'), with         */
+/* independent runs ('penalGrid'), replica exchange          */
+/* ('penalPT'), histogram reweighting ('penalReweight'),     */
+/* warm-started runs ('penalWarm') or adaptive refinement    */
+/* ('penalAdapt'), or else with the exact posterior          */
+/* ('penalExact'). Creates 3 files containing the penalty    */
+/* value versus:                                             */
 /*    penal1: Non-normalized log-posterior probability       */
 /*            with penalty.                                  */
 /*    penal2: Non-normalized log-posterior probability       */
 /*            without penalty.                               */
 /*    penal3: Empirical probability obtained from the        */
-/*            Monte Carlo.                                   */
-static void penalMetMCMC (char *outPath, spkInfo *tkt,
+/*            Monte Carlo (not created without histogram,    */
+/*            i.e. with 'STnone').                           */
+static void penalMetMCMC (char *outPath, spkInfo *tkt, statsInfo *stats,
 			  double ini, double end, double delta)
 {
-   int length, cont;
-   double *logPP; /* log-posterior probability */
+   int i, length;
+   double pen;
+   sweepInfo s; /* state of the sweep */
    char *outName1, *outName2, *outName3; /* names of the output files */
-   FILE *out1, *out2, *out3; /* files for output */
 
    /* Initializes variables. */
-   logPP = UTILmalloc (3 * sizeof (double)); /* log-posterior probability */
-   length = size (outPath);
+   length = strlen (outPath);
    outName1 = UTILmalloc ((length + 26) * sizeof (char));
    outName2 = UTILmalloc ((length + 26) * sizeof (char));
    outName3 = UTILmalloc ((length + 26) * sizeof (char));
+   s.outName = UTILmalloc ((length + 35) * sizeof (char));
    outName1[0] = '\0';
    outName2[0] = '\0';
    outName3[0] = '\0';
+   s.outName[0] = '\0';
    sprintf (outName1, "%spenal1M%d%sp%dMet%d.dat",
 	    outPath, rat, region, part, met);
    sprintf (outName2, "%spenal2M%d%sp%dMet%d.dat",
 	    outPath, rat, region, part, met);
    sprintf (outName3, "%spenal3M%d%sp%dMet%d.dat",
 	    outPath, rat, region, part, met);
+   sprintf (s.outName, "%soutputM%d%sp%dMet%d.dat",
+	    outPath, rat, region, part, met);
 
    /* Some user interaction. */
    printf ("\n  method %d", met);
    setvbuf (stdout, NULL, _IONBF, 0); /* print now! */
 
    /* Opens the output files. */
-   out1 = UTILfopen (outName1, "w");
-   out2 = UTILfopen (outName2, "w");
-   out3 = UTILfopen (outName3, "w");
+   s.out1 = UTILfopen (outName1, "w");
+   s.out2 = UTILfopen (outName2, "w");
+   s.out3 = (stKind == STnone && !exact) ? NULL /* no histogram */
+      : UTILfopen (outName3, "w");
+
+   /* Penalty values (accumulated as in a serial loop). */
+   for (s.Npoints = 0, pen = ini; pen < end; pen += delta)
+      s.Npoints++;
+   s.pen = UTILmalloc ((s.Npoints + 1) * sizeof (double));
+   for (i = 0, pen = ini; pen < end; pen += delta)
+      s.pen[i++] = pen;
+
+   /* Streams of the generators (the chains of each penalty    */
+   /* value jump ahead from its stream, see 'mcChains').       */
+   s.rng = UTILmalloc ((s.Npoints + 1) * sizeof (Rng));
+   RNGseed (&s.rng[0], seed);
+   for (i = 1; i < s.Npoints; i++) {
+      s.rng[i] = s.rng[i-1];
+      RNGlongJump (&s.rng[i]);
+   }
 
-   /* Looping over penalty values. */
-   for (cont = 0, penal = ini; penal < end; penal += delta) {
-      /* Markov Chain Monte Carlo. */
-      mcmc (0, outPath, tkt, logPP);
-
-      /* Writes results. */
-      fprintf (out1, "%.7f  %.10f\n", penal, logPP[0]);
-      fflush (out1); /* print now! */
-      fprintf (out2, "%.7f  %.10f\n", penal, logPP[1]);
-      fflush (out2); /* print now! */
-      fprintf (out3, "%.7f  %.10f\n", penal, logPP[2]);
-      fflush (out3); /* print now! */
-
-      /* Just to avoid unnecessary computation. */
-      if (logPP[0] < 0.0000001) {
-	 cont++;
-	 if (cont > 10)
-	    break;
-      }
+   /* Initializes the sweep. */
+   Nedges = Nneuron * (Nneuron - 1) / 2; /* # of edges */
+   ITEMinit (Nedges); /* graphs with 'Nedges' elements */
+   s.Vij = gibbsEn (stats); /* the same for all penalty values */
+   s.res = UTILmalloc ((s.Npoints + 1) * sizeof (resultInfo));
+   s.done = UTILmalloc ((s.Npoints + 1) * sizeof (int));
+   for (i = 0; i < s.Npoints; i++)
+      s.done[i] = 0;
+   s.next = s.zeros = 0;
+   s.cut = s.Npoints;
+   s.tkt = tkt;
 
-   } /* for (cont = 0, penal = ... */
+   /* Looping over penalty values. */
+   if (exact)
+      penalExact (&s);
+   else if (sweepKind == SWEEPpt)
+      penalPT (outPath, &s);
+   else if (sweepKind == SWEEPreweight)
+      penalReweight (outPath, &s);
+   else if (sweepKind == SWEEPwarm)
+      penalWarm (&s);
+   else if (sweepKind == SWEEPadaptive)
+      penalAdapt (&s);
+   else
+      penalGrid (&s);
 
    /* Closes the output files. */
-   fclose (out1);
-   fclose (out2);
-   fclose (out3);
+   fclose (s.out1);
+   fclose (s.out2);
+   if (s.out3 != NULL)
+      fclose (s.out3);
 
    /* Frees memory. */
+   free (s.Vij);
+   free (s.pen);
+   free (s.rng);
+   free (s.res);
+   free (s.done);
    free (outName1);
    free (outName2);
    free (outName3);
-   free (logPP);
+   free (s.outName);
 
 } /* penalMetMCMC */
 
@@ -695,12 +3252,15 @@ static void neuroPenal (char *dataFile, char *outPath)
    int i, mouse;
    double min, max; /* 'min' and 'max' spike times in a set */
    spkInfo *tkt; /* vector with electrode label and spikes */
-   char spkPath[150]; /* path to the spikes data */
+   statsInfo *stats; /* sufficient statistics of the spikes */
    char aux1[5], aux2[150];
+   char *cacheName; /* binary cache with the binned spikes */
+   cacheInfo cache; /* cache mapped into memory */
    FILE *summary; /* file containing a summary of data */
 
    /* Opens the input file with data paths. */
    summary = UTILfopen (dataFile, "r");
+   cacheName = UTILmalloc ((strlen (dataFile) + 25) * sizeof (char));
 
    /* Looping over the mouses. */
    while (fscanf (summary, "%d%d", &mouse, &Nneuron) == 2) {
@@ -722,33 +3282,36 @@ static void neuroPenal (char *dataFile, char *outPath)
 	    tkt = UTILmalloc (Nneuron * sizeof (spkInfo));
 
 	    /* Looping over the neurons. */
-	    for (i = 0; i < Nneuron; i++) {
-	       
+	    for (i = 0; i < Nneuron; i++)
 	       /* Reads the neuron's label and the path to the spikes data. */
 	       UTILcheckFscan (fscanf (summary, "%s%s",
-				       tkt[i].label, spkPath), dataFile);
-	 
-	       /* Gets the spikes. */
-	       tkt[i].spikes = spkRead (spkPath, min);
-	    }
+				       tkt[i].label, tkt[i].path), dataFile);
+
+	    /* Gets the spikes (from the cache, if it is up to date). */
+	    sprintf (cacheName, "%s.spkM%d.bin", dataFile, mouse);
+	    spkLoad (cacheName, tkt, min, &cache);
+
+	    /* Counts the spikes once for all methods and penalties. */
+	    stats = spkStats (tkt);
 
 	    /* Computes the MCMC with different methods for computing the */
 	    /* posterior probability and with different penalty values.   */
 
 	    /* First method: <Xi|Xj>=1 if Xi=1 and Xj=1. */
 	    met = 1;
-	    penalMetMCMC (outPath, tkt, 0.00001, 0.1, 0.0001);
+	    penalMetMCMC (outPath, tkt, stats, 0.00001, 0.1, 0.0001);
 
 	    /* Second method: <Xi|Xj>=1 if Xi=Xj or <Xi|Xj>=0 (if Xi!=Xj). */
 	    met = 2;
-	    penalMetMCMC (outPath, tkt, 0.6, 1.0, 0.001);
+	    penalMetMCMC (outPath, tkt, stats, 0.6, 1.0, 0.001);
 
 	    /* Third method: <Xi|Xj>=1 if Xi=Xj or <Xi|Xj>=-1 (if Xi!=Xj). */
 	    met = 3;
-	    penalMetMCMC (outPath, tkt, 0.2, 1.0, 0.001);	 
+	    penalMetMCMC (outPath, tkt, stats, 0.2, 1.0, 0.001);	 
 
 	    /* Frees memory. */
-	    spkFree (tkt);
+	    statsFree (stats);
+	    spkFree (tkt, &cache);
 	 }
 	 else {
 	    /* Looping over the neurons. */
@@ -772,6 +3335,7 @@ static void neuroPenal (char *dataFile, char *outPath)
 
    /* Closes the input file. */
    fclose (summary);
+   free (cacheName);
 
 } /* neuroPenal */
 
@@ -790,14 +3354,16 @@ static void neuro (char *dataFile, char *outPath)
 {
    int i, mouse;
    double min, max; /* 'min' and 'max' spike times in a set */
-   double *aux = &min;
    spkInfo *tkt; /* vector with electrode label and spikes */
-   char spkPath[150]; /* path to the spikes data */
+   statsInfo *stats; /* sufficient statistics of the spikes */
    char aux1[5], aux2[150];
+   char *cacheName; /* binary cache with the binned spikes */
+   cacheInfo cache; /* cache mapped into memory */
    FILE *summary; /* file containing a summary of data */
 
    /* Opens the input file with data paths. */
    summary = UTILfopen (dataFile, "r");
+   cacheName = UTILmalloc ((strlen (dataFile) + 25) * sizeof (char));
 
    /* Looping over the mouses. */
    while (fscanf (summary, "%d%d", &mouse, &Nneuron) == 2) {
@@ -819,21 +3385,24 @@ static void neuro (char *dataFile, char *outPath)
 	    tkt = UTILmalloc (Nneuron * sizeof (spkInfo));
 
 	    /* Looping over the neurons. */
-	    for (i = 0; i < Nneuron; i++) {
-
+	    for (i = 0; i < Nneuron; i++)
 	       /* Reads the neuron's label and the path to the spikes data. */
 	       UTILcheckFscan (fscanf (summary, "%s%s",
-				       tkt[i].label, spkPath), dataFile);
-	 
-	       /* Gets the spikes. */
-	       tkt[i].spikes = spkRead (spkPath, min);
-	    }
+				       tkt[i].label, tkt[i].path), dataFile);
+
+	    /* Gets the spikes (from the cache, if it is up to date). */
+	    sprintf (cacheName, "%s.spkM%d.bin", dataFile, mouse);
+	    spkLoad (cacheName, tkt, min, &cache);
+
+	    /* Counts the spikes once for all methods and penalties. */
+	    stats = spkStats (tkt);
 
 	    /* Markov Chain Monte Carlo. */
-	    mcmc (1, outPath, tkt, aux);
+	    mcBestGraph (outPath, tkt, stats);
 
 	    /* Frees memory. */
-	    spkFree (tkt);
+	    statsFree (stats);
+	    spkFree (tkt, &cache);
 	 }
 	 else {
 	    /* Loop over the neurons. */
@@ -857,6 +3426,7 @@ static void neuro (char *dataFile, char *outPath)
 
    /* Closes the input file. */
    fclose (summary);
+   free (cacheName);
 
 } /* neuro */
 
@@ -875,8 +3445,10 @@ void NEURObestGraph (char *dataPath, char *outPath)
    int length;
    char *file;
 
-   length = size (dataPath);
+   length = strlen (dataPath);
    file = UTILmalloc ((length + 20) * sizeof (char));
+   BITSinit (BITSbest); /* fastest population count */
+   checkOptions ();
 
    /* First part of the experiment (before contacts). */
    printf ("\n Mouse %d - %s region - part 1", rat, region);
@@ -914,8 +3486,10 @@ void NEUROpenalAnalysis (char *dataPath, char *outPath)
    int length;
    char *file;
 
-   length = size (dataPath);
+   length = strlen (dataPath);
    file = UTILmalloc ((length + 20) * sizeof (char));
+   BITSinit (BITSbest); /* fastest population count */
+   checkOptions ();
 
    /* First part of the experiment (before contacts). */
    printf ("\n Mouse %d - %s region - part 1", rat, region);
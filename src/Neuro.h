@@ -31,6 +31,54 @@ void NEUROsetMethod (char *method);
 /* Sets the penalty constant chosen by the user. */
 void NEUROsetPenal (char *penalty);
 
+/* Sets the symbol-table implementation ("list", "hash" or "none"). */
+void NEUROsetST (char *kind);
+
+/* Sets the bounded symbol-table with the 'K' most visited graphs. */
+void NEUROsetTopK (char *K);
+
+/* Sets the computation of the marginal probabilities of the edges. */
+void NEUROsetMarginals ();
+
+/* Sets the number of independent chains (one thread each). */
+void NEUROsetChains (char *chains);
+
+/* Sets the number of threads of the penalty analysis. */
+void NEUROsetThreads (char *threads);
+
+/* Sets the penalty sweep ("grid", "pt", "reweight", "warm" or */
+/* "adaptive").                                                 */
+void NEUROsetSweep (char *kind);
+
+/* Sets the number of anchor penalties of the reweighted sweep. */
+void NEUROsetAnchors (char *A);
+
+/* Sets the points between the coarse points of the adaptive sweep. */
+void NEUROsetStride (char *S);
+
+/* Sets the tolerance of the log-posterior refined by the */
+/* adaptive sweep.                                         */
+void NEUROsetRefine (char *T);
+
+/* Sets the seed of the pseudo-random generators. */
+void NEUROsetSeed (char *number);
+
+/* Sets the tolerance of the stop rule of the chains. */
+void NEUROsetTol (char *T);
+
+/* Sets the seconds between the checkpoints of the chains. */
+void NEUROsetCheckpoint (char *S);
+
+/* Sets the chains to resume from their last checkpoint. */
+void NEUROsetResume ();
+
+/* Sets the exact computation of the posterior (the edges are */
+/* independent) instead of the Markov Chain Monte Carlo.      */
+void NEUROsetExact ();
+
+/* Sets the sampling kernel of the chains ("metropolis" or "gibbs"). */
+void NEUROsetKernel (char *kind);
+
 /* Estimates for each mouse the graph that best represents the  */
 /* observed data in the first and third parts of the experiment */
 /* for a fixed penalty value and method (1, 2 and 3) of         */
@@ -0,0 +1,232 @@
+/**  *****************************************************  **/
+/**       ** Finding the Most Representative Graph **       **/
+/**       **    Model for Neuronal Interactions    **       **/
+/**       **     via Markov Chain Monte Carlo      **       **/
+/**                                                         **/
+/**   Author: Pedro Brandimarte Mendonca                    **/
+/**                                                         **/
+/**  *****************************************************  **/
+/**  Implementation of a work-stealing pool of threads.     **/
+/**  The tasks are dealt to the workers in a round-robin    **/
+/**  way, so each deque holds an increasing sequence of     **/
+/**  indices. A worker always takes the first task of its   **/
+/**  own deque and, when it is empty, steals the first task **/
+/**  of the deque whose first task has the smallest index.  **/
+/**  Thus the tasks are started roughly in the order of     **/
+/**  their indices and the cancelled ones (see              **/
+/**  'POOLcancel') are rarely started. Each deque has its   **/
+/**  own lock, so the workers only compete for the locks    **/
+/**  when they steal tasks.                                 **/
+/**  *****************************************************  **/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <unistd.h>
+#include <pthread.h>
+#include "Utils.h"
+#include "Pool.h"
+
+/* Deque of a worker: its tasks are 'task[head..tail-1]'. */
+typedef struct {
+   pthread_mutex_t lock;
+   int *task;
+   int head, tail;
+} deque;
+
+/* A pool has the deques of its 'n' workers, the procedure    */
+/* 'work' (and its argument 'arg') that runs each task and    */
+/* the index 'cut' of the first cancelled task.               */
+struct POOLpool {
+   int n;
+   deque *dq;
+   void (*work)(Pool, int, void *);
+   void *arg;
+   pthread_mutex_t lock; /* protects 'cut' */
+   int cut;
+};
+
+/* Argument of each worker thread. */
+typedef struct { Pool p; int w; } worker;
+
+
+/* ********************************************************* */
+/* Returns the first task of the deque 'd' and removes it    */
+/* from the deque, or returns '-1' if it is empty.           */
+static int pop (deque *d)
+{
+   int task = -1;
+
+   pthread_mutex_lock (&d->lock);
+   if (d->head < d->tail)
+      task = d->task[d->head++];
+   pthread_mutex_unlock (&d->lock);
+
+   return task;
+
+} /* pop */
+
+
+/* ********************************************************* */
+/* Returns the index of the first task of the deque 'd', or  */
+/* '-1' if it is empty.                                      */
+static int first (deque *d)
+{
+   int task = -1;
+
+   pthread_mutex_lock (&d->lock);
+   if (d->head < d->tail)
+      task = d->task[d->head];
+   pthread_mutex_unlock (&d->lock);
+
+   return task;
+
+} /* first */
+
+
+/* ********************************************************* */
+/* Returns the next task of the worker 'w' of the pool 'p':  */
+/* the first one of its own deque or, if it is empty, the    */
+/* first one of the deque (of other worker) whose first task */
+/* has the smallest index. Returns '-1' when all the deques  */
+/* are empty (no task is added after the pool has started).  */
+static int next (Pool p, int w)
+{
+   int i, v, task, min;
+
+   while (1) {
+      if ((task = pop (&p->dq[w])) >= 0)
+	 return task;
+
+      /* Chooses the victim. */
+      for (v = -1, min = -1, i = 0; i < p->n; i++) {
+	 if (i == w || (task = first (&p->dq[i])) < 0)
+	    continue;
+	 if (v < 0 || task < min) {
+	    v = i;
+	    min = task;
+	 }
+      }
+      if (v < 0) /* nothing left */
+	 return -1;
+
+      /* Steals (another thief may have been faster). */
+      if ((task = pop (&p->dq[v])) >= 0)
+	 return task;
+   }
+
+} /* next */
+
+
+/* ********************************************************* */
+/* Start routine of the worker threads: runs tasks until     */
+/* there are no tasks left, skipping the cancelled ones.     */
+static void *runWorker (void *arg)
+{
+   int task, cut;
+   Pool p = ((worker *) arg)->p;
+   int w = ((worker *) arg)->w;
+
+   while ((task = next (p, w)) >= 0) {
+      pthread_mutex_lock (&p->lock);
+      cut = p->cut;
+      pthread_mutex_unlock (&p->lock);
+      if (task < cut)
+	 p->work (p, task, p->arg);
+   }
+
+   return NULL;
+
+} /* runWorker */
+
+
+/* ********************************************************* */
+/* Runs the tasks '0' to 'ntasks-1' with 'nthreads' workers, */
+/* calling 'work(p, task, arg)' for each one of them. The    */
+/* worker 0 runs at the calling thread and each other worker */
+/* at its own thread. Returns when all tasks are done (or    */
+/* cancelled).                                               */
+void POOLrun (int nthreads, int ntasks,
+	      void (*work)(Pool, int task, void *arg), void *arg)
+{
+   int i, w;
+   struct POOLpool pool;
+   worker *wk;
+   pthread_t *tid;
+
+   if (nthreads > ntasks)
+      nthreads = ntasks;
+   if (nthreads < 1)
+      return; /* no tasks */
+
+   pool.n = nthreads;
+   pool.work = work;
+   pool.arg = arg;
+   pool.cut = ntasks;
+   pthread_mutex_init (&pool.lock, NULL);
+
+   /* Deals the tasks to the workers. */
+   pool.dq = UTILmalloc (nthreads * sizeof (deque));
+   for (w = 0; w < nthreads; w++) {
+      pthread_mutex_init (&pool.dq[w].lock, NULL);
+      pool.dq[w].task = UTILmalloc ((ntasks / nthreads + 1) * sizeof (int));
+      pool.dq[w].head = pool.dq[w].tail = 0;
+   }
+   for (i = 0; i < ntasks; i++) {
+      w = i % nthreads;
+      pool.dq[w].task[pool.dq[w].tail++] = i;
+   }
+
+   /* Runs the workers. */
+   wk = UTILmalloc (nthreads * sizeof (worker));
+   tid = UTILmalloc (nthreads * sizeof (pthread_t));
+   for (w = 0; w < nthreads; w++) {
+      wk[w].p = &pool;
+      wk[w].w = w;
+   }
+   for (w = 1; w < nthreads; w++)
+      if (pthread_create (&tid[w], NULL, runWorker, &wk[w]) != 0) {
+	 fprintf (stderr, "\n Error: could not create thread %d!\n\n", w);
+	 exit (EXIT_FAILURE);
+      }
+   runWorker (&wk[0]);
+   for (w = 1; w < nthreads; w++)
+      pthread_join (tid[w], NULL);
+
+   /* Frees memory. */
+   for (w = 0; w < nthreads; w++) {
+      pthread_mutex_destroy (&pool.dq[w].lock);
+      free (pool.dq[w].task);
+   }
+   pthread_mutex_destroy (&pool.lock);
+   free (pool.dq);
+   free (wk);
+   free (tid);
+
+} /* POOLrun */
+
+
+/* ********************************************************* */
+/* Cancels the tasks with index greater or equal to 'from'   */
+/* that have not been started yet (the tasks already running */
+/* are not interrupted).                                     */
+void POOLcancel (Pool p, int from)
+{
+   pthread_mutex_lock (&p->lock);
+   if (from < p->cut)
+      p->cut = from;
+   pthread_mutex_unlock (&p->lock);
+
+} /* POOLcancel */
+
+
+/* ********************************************************* */
+/* Returns the number of online processors (at least 1).     */
+int POOLcores ()
+{
+   long n;
+
+   n = sysconf (_SC_NPROCESSORS_ONLN);
+
+   return (n < 1) ? 1 : (int) n;
+
+} /* POOLcores */
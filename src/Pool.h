@@ -0,0 +1,32 @@
+/**  *****************************************************  **/
+/**       ** Finding the Most Representative Graph **       **/
+/**       **    Model for Neuronal Interactions    **       **/
+/**       **     via Markov Chain Monte Carlo      **       **/
+/**                                                         **/
+/**   Author: Pedro Brandimarte Mendonca                    **/
+/**                                                         **/
+/**  *****************************************************  **/
+/**  Interface for a pool of threads that runs a set of     **/
+/**  independent tasks, identified by their indices         **/
+/**  '0, 1, ..., n-1'. Each worker has its own deque of     **/
+/**  tasks and, when it runs out of them, it steals tasks   **/
+/**  from the others. The tasks are taken in the order of   **/
+/**  their indices, so that the results can be used (or     **/
+/**  written) in order as soon as possible, and the tasks   **/
+/**  beyond a given index can be cancelled.                 **/
+/**  *****************************************************  **/
+
+/* Handle of a pool of threads. */
+typedef struct POOLpool *Pool;
+
+/* Runs the tasks '0' to 'ntasks-1' with 'nthreads' workers */
+/* (calling 'work' for each task) and waits for all of them. */
+void POOLrun (int nthreads, int ntasks,
+	      void (*work)(Pool, int task, void *arg), void *arg);
+
+/* Cancels the tasks with index greater or equal to 'from' */
+/* that have not been started yet.                          */
+void POOLcancel (Pool, int from);
+
+/* Returns the number of online processors. */
+int POOLcores ();
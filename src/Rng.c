@@ -0,0 +1,160 @@
+/**  *****************************************************  **/
+/**       ** Finding the Most Representative Graph **       **/
+/**       **    Model for Neuronal Interactions    **       **/
+/**       **     via Markov Chain Monte Carlo      **       **/
+/**                                                         **/
+/**   Author: Pedro Brandimarte Mendonca                    **/
+/**                                                         **/
+/**  *****************************************************  **/
+/**  Implementation of the "xoshiro256**" generator (see    **/
+/**  D. Blackman and S. Vigna, "Scrambled linear            **/
+/**  pseudorandom number generators", ACM TOMS 47, 2021).   **/
+/**  The state is seeded with "splitmix64", which never     **/
+/**  gives the (forbidden) state with all words equal to 0, **/
+/**  and the bounded integers are drawn by Lemire's         **/
+/**  multiply-and-reject method, which needs no division    **/
+/**  in almost all draws.                                   **/
+/**  *****************************************************  **/
+
+#include "Rng.h"
+
+#define rotl(x,k) (((x) << (k)) | ((x) >> (64 - (k))))
+
+
+/* ********************************************************* */
+/* Returns the next value of the "splitmix64" generator with */
+/* state 's'.                                                */
+static unsigned long splitmix (unsigned long *s)
+{
+   unsigned long z;
+
+   z = (*s += 0x9E3779B97F4A7C15UL);
+   z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9UL;
+   z = (z ^ (z >> 27)) * 0x94D049BB133111EBUL;
+
+   return z ^ (z >> 31);
+
+} /* splitmix */
+
+
+/* ********************************************************* */
+/* Initializes the state 'r' from the number 'seed'.         */
+void RNGseed (Rng *r, unsigned long seed)
+{
+   int i;
+
+   for (i = 0; i < 4; i++)
+      r->s[i] = splitmix (&seed);
+
+} /* RNGseed */
+
+
+/* ********************************************************* */
+/* Returns a pseudo-random 64-bit word and advances 'r'.     */
+unsigned long RNGnext (Rng *r)
+{
+   unsigned long *s = r->s;
+   unsigned long x, t;
+
+   x = rotl (s[1] * 5, 7) * 9;
+   t = s[1] << 17;
+
+   s[2] ^= s[0];
+   s[3] ^= s[1];
+   s[1] ^= s[2];
+   s[0] ^= s[3];
+   s[2] ^= t;
+   s[3] = rotl (s[3], 45);
+
+   return x;
+
+} /* RNGnext */
+
+
+/* ********************************************************* */
+/* Advances 'r' by the number of draws given by the jump     */
+/* polynomial 'jump' (computed by the authors of the         */
+/* generator).                                               */
+static void jumpBy (Rng *r, const unsigned long *jump)
+{
+   int i, b;
+   unsigned long s[4];
+
+   s[0] = s[1] = s[2] = s[3] = 0;
+   for (i = 0; i < 4; i++)
+      for (b = 0; b < 64; b++) {
+	 if (jump[i] & (1UL << b)) {
+	    s[0] ^= r->s[0];
+	    s[1] ^= r->s[1];
+	    s[2] ^= r->s[2];
+	    s[3] ^= r->s[3];
+	 }
+	 RNGnext (r);
+      }
+
+   for (i = 0; i < 4; i++)
+      r->s[i] = s[i];
+
+} /* jumpBy */
+
+
+/* ********************************************************* */
+/* Advances 'r' by 2^128 draws.                              */
+void RNGjump (Rng *r)
+{
+   static const unsigned long jump[] = {
+      0x180EC6D33CFD0ABAUL, 0xD5A61266F0C9392CUL,
+      0xA9582618E03FC9AAUL, 0x39ABDC4529B1661CUL };
+
+   jumpBy (r, jump);
+
+} /* RNGjump */
+
+
+/* ********************************************************* */
+/* Advances 'r' by 2^192 draws.                              */
+void RNGlongJump (Rng *r)
+{
+   static const unsigned long jump[] = {
+      0x76E15D3EFEFDCBBFUL, 0xC5004E441C522FB3UL,
+      0x77710069854EE241UL, 0x39109BB02ACBE635UL };
+
+   jumpBy (r, jump);
+
+} /* RNGlongJump */
+
+
+/* ********************************************************* */
+/* Returns a pseudo-random number u ~ Unif[0,1) with 53      */
+/* random bits (the precision of a double).                  */
+double RNGunif (Rng *r)
+{
+   return (RNGnext (r) >> 11) * (1.0 / 9007199254740992.0); /* 2^-53 */
+
+} /* RNGunif */
+
+
+/* ********************************************************* */
+/* Returns an unbiased pseudo-random integer in [0,n-1]      */
+/* (with '1 <= n <= 2^32'). The upper 32 bits 'x' of a draw  */
+/* are mapped to 'x n / 2^32' and, to remove the bias, the   */
+/* draws whose low part of 'x n' is below '2^32 mod n' are   */
+/* rejected (the remainder is only computed when the low     */
+/* part is below 'n', which is rare).                        */
+unsigned long RNGbounded (Rng *r, unsigned long n)
+{
+   unsigned long m, low, t;
+
+   m = (RNGnext (r) >> 32) * n;
+   low = m & 0xFFFFFFFFUL;
+   if (low < n) {
+      t = (0x100000000UL - n) % n; /* 2^32 mod n */
+      while (low < t) {
+	 m = (RNGnext (r) >> 32) * n;
+	 low = m & 0xFFFFFFFFUL;
+      }
+   }
+
+   return m >> 32;
+
+} /* RNGbounded */
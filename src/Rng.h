@@ -0,0 +1,41 @@
+/**  *****************************************************  **/
+/**       ** Finding the Most Representative Graph **       **/
+/**       **    Model for Neuronal Interactions    **       **/
+/**       **     via Markov Chain Monte Carlo      **       **/
+/**                                                         **/
+/**   Author: Pedro Brandimarte Mendonca                    **/
+/**                                                         **/
+/**  *****************************************************  **/
+/**  Interface for a pseudo-random number generator with    **/
+/**  explicit state ("xoshiro256**" by Blackman and Vigna). **/
+/**  Each user (e.g. each Markov chain) keeps its own state **/
+/**  'Rng', so the generators share no hidden state and can **/
+/**  be used by different threads at the same time.         **/
+/**  Independent streams are obtained from a single seed    **/
+/**  by jumping ahead: 'RNGjump' advances the state by      **/
+/**  2^128 draws and 'RNGlongJump' by 2^192 draws, so that  **/
+/**  the streams never overlap in practice.                 **/
+/**  Obs.: it assumes that 'unsigned long' has 64 bits.     **/
+/**  *****************************************************  **/
+
+/* State of a generator (its fields must not be used). */
+typedef struct { unsigned long s[4]; } Rng;
+
+/* Initializes the state 'r' from the number 'seed'. */
+void RNGseed (Rng *r, unsigned long seed);
+
+/* Advances 'r' by 2^128 draws (a new stream). */
+void RNGjump (Rng *r);
+
+/* Advances 'r' by 2^192 draws (a new set of 2^64 streams). */
+void RNGlongJump (Rng *r);
+
+/* Returns a pseudo-random 64-bit word. */
+unsigned long RNGnext (Rng *r);
+
+/* Returns a pseudo-random number u ~ Unif[0,1). */
+double RNGunif (Rng *r);
+
+/* Returns an unbiased pseudo-random integer in [0,n-1], */
+/* for '1 <= n <= 2^32'.                                 */
+unsigned long RNGbounded (Rng *r, unsigned long n);
@@ -12,41 +12,94 @@
 /**  Abstract data type interface for symbol-table whose    **/
 /**  items have a counter that is incremented each time     **/
 /**  the item is searched.                                  **/
+/**  There are four implementations of this interface,      **/
+/**  chosen at run time when the symbol-table is created:   **/
+/**    - STlist: a skip list (see STlist.c), which keeps    **/
+/**    the items ordered by their hashes;                   **/
+/**    - SThash: a hash table with open addressing (see     **/
+/**    SThash.c), which has faster searches and only sorts  **/
+/**    the items when they are visited by 'STsort';         **/
+/**    - STtopk: a table with at most 'K' items (see        **/
+/**    STtopk.c), which evicts the item with the smallest   **/
+/**    score when it is full, so its scores are estimates   **/
+/**    with a known error bound (see 'STerrBound');         **/
+/**    - STnone: a disabled table (see STnone.c), which     **/
+/**    only keeps the last item and the total score.        **/
+/**  Each call to 'STinit' creates an independent table     **/
+/**  and all operations receive its handle, so several      **/
+/**  tables can be used at the same time (by different      **/
+/**  threads, as long as each table is used by one thread   **/
+/**  at a time).                                            **/
 /**  *****************************************************  **/
 
-/* Initializes. */
-void STinit ();
+/* Symbol-table implementations. */
+#define STlist 0 /* skip list */
+#define SThash 1 /* hash table */
+#define STtopk 2 /* bounded ("Space-Saving") table */
+#define STnone 3 /* disabled table (no histogram) */
 
-/* Adds a new item. */
-void STinsert (Item);
+/* Handle of a symbol-table. */
+typedef struct STtable *ST;
+
+/* Reference to the stored copy of an item and its counter */
+/* (valid while the item is in the symbol-table).          */
+typedef void *STref;
+
+/* Creates a symbol-table with the implementation 'kind' */
+/* (the bounded ones keep at most 'max' items).           */
+ST STinit (int kind, int max);
+
+/* Adds a copy of a new item and returns the copy. */
+Item STinsert (ST, Item);
 
 /* Searches an item with a given key. */
-Item STsearch (Key);
+Item STsearch (ST, Key);
+
+/* Adds 'n' to the counter of an item (inserting a copy with */
+/* counter 'n' if it is new) and returns the stored copy.     */
+Item STadd (ST, Item, unsigned long n);
+
+/* As 'STadd', but returns a reference to the stored copy. */
+STref STaddRef (ST, Item, unsigned long n);
+
+/* Returns the stored copy of the item of a reference. */
+Item STrefItem (ST, STref);
+
+/* Adds 'n' to the counter of the item of a reference. */
+void STrefAdd (ST, STref, unsigned long n);
 
 /* Removes an item. */
-void STdelete (Item);
+void STdelete (ST, Item);
 
-/* Returns the "int"-th smallest item. */
-Item STselect (int);
+/* Returns the "int"-th smallest item (in the order of the */
+/* keys, see 'ITEMkeyCompare').                             */
+Item STselect (ST, int);
 
 /* Visit the items in the order of their keys (calling */
 /* a procedure passed as an argument for each item).   */
-void STsort (FILE *std, void (*visit)(FILE *std, Item));
+void STsort (ST, FILE *std, void (*visit)(FILE *std, Item));
+
+/* Visit the items in any order (calling a procedure passed */
+/* as an argument with each item, its counter and 'arg').    */
+void STwalk (ST, void (*visit)(Item, unsigned long, void *), void *arg);
 
 /* Return the quantity of different items. */
-int STcount ();
+int STcount (ST);
 
 /* Returns the key of the highest score item. */
-Key STmaxItem ();
+Key STmaxItem (ST);
 
 /* Prints at 'std' the key of the highest score item. */
-void STshowMaxItem (FILE *std);
+void STshowMaxItem (ST, FILE *std);
 
 /* Returns the score of the highest score item. */
-unsigned long STmaxCont ();
+unsigned long STmaxCont (ST);
+
+/* Returns an upper bound of the overestimation of the scores. */
+unsigned long STerrBound (ST);
 
 /* Returns the sum of the scores of all items. */
-unsigned long STtotalCount ();
+unsigned long STtotalCount (ST);
 
 /* Frees memory (destroys the symbol-table). */
-void STfree ();
+void STfree (ST);
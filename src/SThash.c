@@ -0,0 +1,477 @@
+/**  *****************************************************  **/
+/**       ** Finding the Most Representative Graph **       **/
+/**       **    Model for Neuronal Interactions    **       **/
+/**       **     via Markov Chain Monte Carlo      **       **/
+/**                                                         **/
+/**   Author: Pedro Brandimarte Mendonca                    **/
+/**                                                         **/
+/**  *****************************************************  **/
+/**  This code is based on R. Sedgewick "Algorithms in C    **/
+/**  Parts 1-4", 3rd Edition, Addison-Wesley (1998).        **/
+/**  *****************************************************  **/
+/**  Abstract data type implementation for hash table       **/
+/**  symbol-table whose entries have a counter that is      **/
+/**  incremented each time an item of an existing entry is  **/
+/**  searched.                                              **/
+/**  The table is a flat array of slots with open           **/
+/**  addressing and linear probing. Each slot keeps the     **/
+/**  full hash value of its item, so that a probe only      **/
+/**  compares the keys when the hash values are equal. The  **/
+/**  table size is a power of 2 and it is doubled whenever  **/
+/**  it becomes half full, which provides searches and      **/
+/**  insertions in constant expected time. The items are    **/
+/**  not ordered, so 'STsort' and 'STselect' sort them at   **/
+/**  the time they are called.                              **/
+/**  The entries and their items are taken from an arena    **/
+/**  (see Utils.h), so the table is freed all at once.      **/
+/**  The operations are exported through 'SThashOps' (see   **/
+/**  STimpl.h) and chosen at 'STinit' with 'SThash'.        **/
+/**  *****************************************************  **/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "Utils.h"
+#include "Item.h"
+#include "STimpl.h"
+
+#define Mini 1024 /* initial number of slots */
+#define SLAB 1048576 /* bytes of each slab of the arena */
+
+/* Each entry has an item and a counter 'cont' that is        */
+/* incremented each time the item is searched. Each slot has  */
+/* the hash value of the item and a pointer to its entry (or  */
+/* NULL if the slot is empty).                                */
+typedef struct HASHentry *link;
+struct HASHentry { Item item; unsigned long cont; };
+typedef struct { unsigned long h; link e; } slot;
+
+/* Each hash table has its own slots, arena and counters, so */
+/* that different tables can be used at the same time.       */
+typedef struct HASHtable *Hash;
+struct HASHtable {
+   slot *st; /* table of slots */
+   Arena arena; /* memory of the entries and their items */
+   unsigned long M; /* number of slots (a power of 2) */
+   int N; /* number of items in the table */
+   unsigned long total; /* sum of the counters of all items */
+   link maxItem; /* element with higher frequency */
+};
+
+
+/* ********************************************************* */
+/* Allocates a table with 'm' empty slots.                   */
+static slot *newTable (unsigned long m)
+{
+   unsigned long i;
+   slot *t;
+
+   t = UTILmalloc (m * sizeof (slot));
+   for (i = 0; i < m; i++)
+      t[i].e = NULL;
+
+   return t;
+
+} /* newTable */
+
+
+/* ********************************************************* */
+/* Creates a hash table with 'Mini' empty slots and the      */
+/* arena for its entries (the table is not bounded, so 'max' */
+/* is not used).                                             */
+static void *HASHinit (int max)
+{
+   Hash h;
+
+   h = UTILmalloc (sizeof *h);
+   h->arena = UTILarenaInit (SLAB);
+   h->M = Mini;
+   h->N = 0;
+   h->total = 0;
+   h->st = newTable (h->M);
+   h->maxItem = NULL;
+
+   return h;
+
+} /* HASHinit */
+
+
+/* ********************************************************* */
+/* Returns the index of the slot of the table 't' that holds */
+/* the item with key 'v' and hash value 'h', or the index of */
+/* the empty slot where it should be inserted.               */
+static unsigned long probe (Hash t, Key v, unsigned long h)
+{
+   unsigned long i;
+   slot *st = t->st;
+
+   for (i = h & (t->M - 1); st[i].e != NULL; i = (i + 1) & (t->M - 1))
+      if (st[i].h == h && eq (v, key (st[i].e->item)))
+	 break;
+
+   return i;
+
+} /* probe */
+
+
+/* ********************************************************* */
+/* Doubles the number of slots of the table 't' and          */
+/* re-inserts all entries. The entries themselves are not    */
+/* moved (only the slots).                                   */
+static void expand (Hash t)
+{
+   unsigned long i, j, oldM, M;
+   slot *old, *st;
+
+   old = t->st;
+   oldM = t->M;
+   M = t->M = 2 * oldM;
+   st = t->st = newTable (M);
+
+   for (i = 0; i < oldM; i++)
+      if (old[i].e != NULL) {
+	 for (j = old[i].h & (M - 1); st[j].e != NULL; j = (j + 1) & (M - 1))
+	    ;
+	 st[j] = old[i];
+      }
+
+   free (old);
+
+} /* expand */
+
+
+/* ********************************************************* */
+/* Adds a copy of a new item, taken from the arena, and      */
+/* returns it (it is assumed that the item is not in the     */
+/* table yet).                                               */
+static Item HASHinsert (void *p, Item item)
+{
+   unsigned long i, h;
+   Hash t = p;
+   link x;
+
+   if (2 * (t->N + 1) > t->M)
+      expand (t); /* keeps the table at most half full */
+
+   x = UTILarenaAlloc (t->arena, sizeof *x);
+   x->item = ITEMdup (t->arena, item); /* content */
+   x->cont = 1; /* initializes the counter */
+
+   h = ITEMhash (key (item));
+   i = probe (t, key (item), h);
+   t->st[i].h = h;
+   t->st[i].e = x;
+
+   t->N++; /* one more item in the table */
+   t->total++;
+
+   /* If 'maxItem' has not yet been initialized... */
+   if (t->maxItem == NULL)
+      t->maxItem = x;
+
+   return x->item;
+
+} /* HASHinsert */
+
+
+/* ********************************************************* */
+/* Searches an item with a given key 'v'. If it is found its */
+/* counter is incremented (and 'maxItem' is updated if       */
+/* necessary), otherwise returns 'NULLitem'.                 */
+static Item HASHsearch (void *p, Key v)
+{
+   unsigned long i;
+   Hash t = p;
+   link x;
+
+   i = probe (t, v, ITEMhash (v));
+   if ((x = t->st[i].e) == NULL) /* not found */
+      return NULLitem;
+
+   x->cont++; /* increments the item counter */
+   t->total++;
+   /* Checks if the item counter exceeded the actual maxItem. */
+   if (t->maxItem->cont < x->cont)
+      t->maxItem = x;
+
+   return x->item;
+
+} /* HASHsearch */
+
+
+/* ********************************************************* */
+/* Adds 'n' to the counter of the item with the key of       */
+/* 'item', inserting a copy of it if it is not in the table, */
+/* and returns its entry.                                    */
+static void *HASHadd (void *p, Item item, unsigned long n)
+{
+   unsigned long i, h;
+   Hash t = p;
+   link x;
+
+   h = ITEMhash (key (item));
+   i = probe (t, key (item), h);
+   if ((x = t->st[i].e) == NULL) { /* new item with counter 'n' */
+      if (2 * (t->N + 1) > t->M) {
+	 expand (t); /* keeps the table at most half full */
+	 i = probe (t, key (item), h);
+      }
+      x = UTILarenaAlloc (t->arena, sizeof *x);
+      x->item = ITEMdup (t->arena, item); /* content */
+      x->cont = 0;
+      t->st[i].h = h;
+      t->st[i].e = x;
+      t->N++; /* one more item in the table */
+      if (t->maxItem == NULL)
+	 t->maxItem = x;
+   }
+
+   x->cont += n;
+   t->total += n;
+   /* Checks if the item counter exceeded the actual maxItem. */
+   if (t->maxItem->cont < x->cont)
+      t->maxItem = x;
+
+   return x;
+
+} /* HASHadd */
+
+
+/* ********************************************************* */
+/* Returns the item of the entry 'r'.                        */
+static Item HASHrefItem (void *r)
+{
+   return ((link) r)->item;
+
+} /* HASHrefItem */
+
+
+/* ********************************************************* */
+/* Adds 'n' to the counter of the entry 'r' of the table     */
+/* 'p' (the entries are never moved, see 'expand').          */
+static void HASHrefAdd (void *p, void *r, unsigned long n)
+{
+   Hash t = p;
+   link x = r;
+
+   x->cont += n;
+   t->total += n;
+   /* Checks if the item counter exceeded the actual maxItem. */
+   if (t->maxItem->cont < x->cont)
+      t->maxItem = x;
+
+} /* HASHrefAdd */
+
+
+/* ********************************************************* */
+/* Returns a pointer to the highest score entry of the table */
+/* 't' (only used to correct 'maxItem' after a removal).     */
+static link searchMaxItem (Hash t)
+{
+   unsigned long i;
+   link newMax = NULL;
+   slot *st = t->st;
+
+   for (i = 0; i < t->M; i++)
+      if (st[i].e != NULL && (newMax == NULL || st[i].e->cont > newMax->cont))
+	 newMax = st[i].e;
+
+   return newMax;
+
+} /* searchMaxItem */
+
+
+/* ********************************************************* */
+/* Removes the item with key 'v'. If its counter is greater  */
+/* than 1 only decrements the counter, otherwise it empties  */
+/* the slot and fills the hole by shifting back the          */
+/* following entries of the same cluster, so that no         */
+/* searches are broken (there is no need of "deleted"        */
+/* marks). The entry stays in the arena until the table is   */
+/* freed.                                                    */
+static void HASHdelete (void *p, Key v)
+{
+   unsigned long i, j, k, M;
+   Hash t = p;
+   slot *st = t->st;
+   link x;
+
+   M = t->M;
+   i = probe (t, v, ITEMhash (v));
+   if ((x = st[i].e) == NULL) /* not found */
+      return;
+
+   t->total--;
+   if (x->cont > 1) { /* only decrements the item's counter */
+      x->cont--;
+      if (t->maxItem == x)
+	 t->maxItem = searchMaxItem (t); /* fixes maxItem pointer */
+      return;
+   }
+
+   /* Backward shift of the cluster after slot 'i'. */
+   st[i].e = NULL;
+   for (j = (i + 1) & (M - 1); st[j].e != NULL; j = (j + 1) & (M - 1)) {
+      k = st[j].h & (M - 1); /* home slot of the entry at 'j' */
+      /* Moves it if 'i' is cyclically in [k, j). */
+      if ((j > i && (k <= i || k > j)) || (j < i && k <= i && k > j)) {
+	 st[i] = st[j];
+	 st[j].e = NULL;
+	 i = j;
+      }
+   }
+
+   t->N--; /* one less item in the table */
+
+   if (t->maxItem == x)
+      t->maxItem = searchMaxItem (t); /* fixes maxItem pointer */
+
+} /* HASHdelete */
+
+
+/* ********************************************************* */
+/* Compares two entries by the keys of their items (used by  */
+/* 'qsort').                                                 */
+static int compEntry (const void *a, const void *b)
+{
+   return ITEMkeyCompare (key ((*(link *) a)->item), key ((*(link *) b)->item));
+
+} /* compEntry */
+
+
+/* ********************************************************* */
+/* Returns a vector with the 'N' entries of the table 't'    */
+/* sorted by the keys of their items.                        */
+static link *sortEntries (Hash t)
+{
+   unsigned long i;
+   int n;
+   link *v;
+
+   v = UTILmalloc ((t->N + 1) * sizeof (link));
+   for (n = 0, i = 0; i < t->M; i++)
+      if (t->st[i].e != NULL)
+	 v[n++] = t->st[i].e;
+   qsort (v, t->N, sizeof (link), compEntry);
+
+   return v;
+
+} /* sortEntries */
+
+
+/* ********************************************************* */
+/* Returns the 'k'-th smallest item or returns 'NULLitem' if */
+/* the table has less then 'k' items.                        */
+static Item HASHselect (void *p, int k)
+{
+   Item item;
+   link *v;
+
+   if (k < 1 || k > ((Hash) p)->N)
+      return NULLitem;
+
+   v = sortEntries (p);
+   item = v[k-1]->item;
+   free (v);
+
+   return item;
+
+} /* HASHselect */
+
+
+/* ********************************************************* */
+/* Visit the items in the order of their keys (calling a     */
+/* procedure passed as an argument for each item).           */
+static void HASHsort (void *p, FILE *std, void (*visit)(FILE *std, Item))
+{
+   int i;
+   link *v;
+
+   v = sortEntries (p);
+   for (i = 0; i < ((Hash) p)->N; i++)
+      visit (std, v[i]->item); /* call the procedure */
+   free (v);
+
+} /* HASHsort */
+
+
+/* ********************************************************* */
+/* Visit the items in the order of the slots (calling a      */
+/* procedure passed as an argument with each item, its       */
+/* counter and 'arg').                                       */
+static void HASHwalk (void *p, void (*visit)(Item, unsigned long, void *),
+		      void *arg)
+{
+   unsigned long i;
+   Hash t = p;
+
+   for (i = 0; i < t->M; i++)
+      if (t->st[i].e != NULL)
+	 visit (t->st[i].e->item, t->st[i].e->cont, arg);
+
+} /* HASHwalk */
+
+
+/* ********************************************************* */
+/* Return the quantity of different items.                   */
+static int HASHcount (void *p)
+{
+   return ((Hash) p)->N;
+
+} /* HASHcount */
+
+
+/* ********************************************************* */
+/* Returns the key of the highest score item.                */
+static Key HASHmaxItem (void *p)
+{
+   return (key(((Hash) p)->maxItem->item));
+
+} /* HASHmaxItem */
+
+
+/* ********************************************************* */
+/* Returns the score of the highest score item.              */
+static unsigned long HASHmaxCont (void *p)
+{
+   return ((Hash) p)->maxItem->cont;
+
+} /* HASHmaxCont */
+
+
+/* ********************************************************* */
+/* Returns the maximum overestimation of the scores (they    */
+/* are exact).                                               */
+static unsigned long HASHerrBound (void *p)
+{
+   return 0;
+
+} /* HASHerrBound */
+
+
+/* ********************************************************* */
+/* Returns the sum of the scores of all items.               */
+static unsigned long HASHtotalCount (void *p)
+{
+   return ((Hash) p)->total;
+
+} /* HASHtotalCount */
+
+
+/* ********************************************************* */
+/* Frees memory of all entries (destroys the symbol-table).  */
+/* The entries and their items are freed with the arena.     */
+static void HASHfree (void *p)
+{
+   UTILarenaFree (((Hash) p)->arena);
+   free (((Hash) p)->st); /* frees the slots */
+   free (p); /* finally, frees the table */
+
+} /* HASHfree */
+
+
+/* Operations of the hash table symbol-table (see STimpl.h). */
+STops SThashOps = { HASHinit, HASHinsert, HASHsearch, HASHadd, HASHrefItem,
+		    HASHrefAdd, HASHdelete, HASHselect, HASHsort, HASHwalk,
+		    HASHcount, HASHmaxItem, HASHmaxCont, HASHerrBound,
+		    HASHtotalCount, HASHfree };
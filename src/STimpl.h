@@ -0,0 +1,50 @@
+/**  *****************************************************  **/
+/**       ** Finding the Most Representative Graph **       **/
+/**       **    Model for Neuronal Interactions    **       **/
+/**       **     via Markov Chain Monte Carlo      **       **/
+/**                                                         **/
+/**   Author: Pedro Brandimarte Mendonca                    **/
+/**                                                         **/
+/**  *****************************************************  **/
+/**  Internal interface between the envelope functions of   **/
+/**  the symbol-table (ST.c) and its implementations. Each  **/
+/**  implementation exports a table of its operations,      **/
+/**  which is chosen at run time by 'STinit'. The meaning   **/
+/**  of each operation is the same of its envelope          **/
+/**  function in ST.h. The state of a symbol-table is kept  **/
+/**  in the structure created by 'init' (never in static    **/
+/**  variables), so each table is independent.              **/
+/**  *****************************************************  **/
+
+/* The first argument of each operation (except 'init', which */
+/* creates it) is the table of the implementation.             */
+typedef struct {
+   void *(*init) (int);
+   Item (*insert) (void *, Item);
+   Item (*search) (void *, Key);
+   void *(*add) (void *, Item, unsigned long); /* returns a reference */
+   Item (*refItem) (void *);
+   void (*refAdd) (void *, void *, unsigned long);
+   void (*delete) (void *, Key);
+   Item (*select) (void *, int);
+   void (*sort) (void *, FILE *std, void (*visit)(FILE *std, Item));
+   void (*walk) (void *, void (*visit)(Item, unsigned long, void *), void *);
+   int (*count) (void *);
+   Key (*maxItem) (void *);
+   unsigned long (*maxCont) (void *);
+   unsigned long (*errBound) (void *);
+   unsigned long (*totalCount) (void *);
+   void (*free) (void *);
+} STops;
+
+/* Skip list (see STlist.c). */
+extern STops STlistOps;
+
+/* Hash table with open addressing (see SThash.c). */
+extern STops SThashOps;
+
+/* Bounded table with the "Space-Saving" algorithm (see STtopk.c). */
+extern STops STtopkOps;
+
+/* Disabled table, without histogram (see STnone.c). */
+extern STops STnoneOps;
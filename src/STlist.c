@@ -0,0 +1,541 @@
+/**  *****************************************************  **/
+/**       ** Finding the Most Representative Graph **       **/
+/**       **    Model for Neuronal Interactions    **       **/
+/**       **     via Markov Chain Monte Carlo      **       **/
+/**                                                         **/
+/**   Author: Pedro Brandimarte Mendonca                    **/
+/**                                                         **/
+/**  *****************************************************  **/
+/**  This code is based on R. Sedgewick "Algorithms in C    **/
+/**  Parts 1-4", 3rd Edition, Addison-Wesley (1998).        **/
+/**  *****************************************************  **/
+/**  Abstract data type implementation for skip list        **/
+/**  symbol-table whose nodes have a counter that is        **/
+/**  incremented each time an item of an existing node is   **/
+/**  searched.                                              **/
+/**  The skip list data structure was developed by Pugh in  **/
+/**  1990. It is an ordered linked list where each node     **/
+/**  contains a variable number of links (set randomly).    **/
+/**  There by, during a search it skips through large       **/
+/**  portions of the list at a time due to the extra links  **/
+/**  in the nodes. This characteristics provides a search,  **/
+/**  insertion and removal of O(log N).                     **/
+/**  The list is ordered by 'ITEMcompare', i.e., by the     **/
+/**  hashes of the items, so 'STsort' and 'STselect' sort   **/
+/**  the items by their keys at the time they are called.   **/
+/**  The operations are exported through 'STlistOps' (see   **/
+/**  STimpl.h) and chosen at 'STinit' with 'STlist'.        **/
+/**  *****************************************************  **/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "Utils.h"
+#include "Rng.h"
+#include "Item.h"
+#include "STimpl.h"
+
+#define lgNmax 30 /* maximum number of levels */
+#define RANDXmax 2147483647L /* maximum value drawn by 'randX' */
+#define SLAB 1048576 /* bytes of each slab of the arena */
+
+/* Each node has an item, an array of links with length 'sz' */
+/* and a counter 'cont' that is incremented each time the    */
+/* item is searched.                                         */
+typedef struct STnode *link;
+struct STnode{ Item item; link *next; int sz; unsigned long cont; };
+
+/* Each skip list has its own head, arena, counters and state */
+/* 'rng' of the generator of the number of links, so that     */
+/* different lists can be used at the same time.              */
+typedef struct LISTtable *List;
+struct LISTtable {
+   link head;
+   Arena arena; /* memory of the nodes and their items */
+   int N; /* number of items in the list */
+   int lgN; /* actual number of levels */
+   link maxItem; /* element with higher frequency */
+   Rng rng; /* state of the generator of 'randX' */
+};
+
+
+/* ********************************************************* */
+/* Creates a new 'STnode' with 'item' content and 'k' links, */
+/* and returns its pointer. The node and its array of links  */
+/* are a single block taken from the arena of the list 'l'.  */
+static link NEW (List l, Item item, int k)
+{
+   int i;
+   link x;
+
+   /* Allocates the 'STnode' followed by its array of links. */
+   x = UTILarenaAlloc (l->arena, sizeof *x + k * sizeof (link));
+   x->next = (link *) (x + 1);
+
+   x->item = item; /* content */
+   x->sz = k; /* number of links */
+   for (i = 0; i < k; i++)
+      x->next[i] = NULL; /* initializes the links with NULL pointer */
+   x->cont = 1; /* initializes the counter */
+
+   /* If 'maxItem' has not yet been initialized... */
+   if (l->maxItem == NULL)
+      l->maxItem = x; /* initializes the maxItem */
+
+   return x;
+
+} /* NEW */
+
+
+/* ********************************************************* */
+/* Creates and initializes a skip list. Creates the arena    */
+/* for the nodes, initializes the item's counter 'N' and the */
+/* actual number of levels 'lgN' with 0, creates the head    */
+/* node with 'NULLitem' content and with 'lgNmax' links and  */
+/* initializes the pointer to the element with higher        */
+/* frequency with 'NULLitem' (the list is not bounded, so    */
+/* 'max' is not used).                                       */
+static void *LISTinit (int max)
+{
+   List l;
+
+   l = UTILmalloc (sizeof *l);
+   l->arena = UTILarenaInit (SLAB); /* memory of the nodes */
+   l->N = 0; /* item's counter */
+   l->lgN = 0; /* actual number of levels */
+   RNGseed (&l->rng, 1); /* state of the generator of 'randX' */
+   l->maxItem = NULL;
+   l->head = NEW (l, NULLitem, lgNmax); /* creates the head node */
+   l->maxItem = NULL; /* initializes the maxItem pointer */
+
+   return l;
+
+} /* LISTinit */
+
+
+/* ********************************************************* */
+/* Generates a pseudo-random number 'i' (number of links of  */
+/* a new node which will be inserted) with probability       */
+/* '1/j^i' (where here 'j' is set equal 2).                  */
+/* Obs.: for large skip lists, the memory space occupied by  */
+/* the extra pointers becomes non-trivial and, in this case, */
+/* the user can change the algorithm below by replacing      */
+/* 'j = 2' by 'j = 3' and 'j = j * 2' by 'j = j * 3'.        */
+/* Each list has its own generator (see Rng.h), so that the  */
+/* lists do not share any hidden state.                      */
+static int randX (List l)
+{
+   int i;
+   long j, t;
+
+   /* Generates a pseudo-random integer in [0,RANDXmax]. */
+   t = (long) (RNGnext (&l->rng) >> 33);
+
+   /* Probability: 1/2, 1/2^2, 1/2^3, ... */
+   for (i = 1, j = 2; i < lgNmax; i++, j = j * 2)
+      if (t > RANDXmax / j)
+	 break;
+
+   if (i > l->lgN)
+      l->lgN = i; /* updates the actual number of levels */
+
+   return i;
+
+} /* randX */
+
+
+/* ********************************************************* */
+/* Recursive function that inserts 'x' after 't' at level    */
+/* 'k', preserving the order of the keys.                    */
+static void insertR (link t, link x, int k)
+{
+   Key v;
+
+   /* Gets 'x' key. */
+   v = key(x->item);
+   if ((t->next[k] == NULL) || less (v, key (t->next[k]->item))) {
+      if (k < x->sz) { /* dancing links... */
+	 x->next[k] = t->next[k];
+	 t->next[k] = x;
+      }
+      if (k == 0) /* the insertion ended */
+	 return;
+      insertR (t, x, k-1); /* tail recursion */
+      return;
+   }
+
+   /* 'x' is after 't->next[k]' */
+   insertR (t->next[k], x, k);
+
+} /* insertR */
+
+
+/* ********************************************************* */
+/* Adds a copy of a new item, taken from the arena, and      */
+/* returns it (envelope function to be exported).            */
+static Item LISTinsert (void *p, Item item)
+{
+   List l = p;
+   link x;
+
+   /* The insertion starts from the 'head'   */
+   /* and at the actual highest level 'lgN'. */
+   x = NEW (l, ITEMdup (l->arena, item), randX (l));
+   insertR (l->head, x, l->lgN);
+   l->N++; /* one more item in the list */
+
+   return x->item;
+
+} /* LISTinsert */
+
+
+/* ********************************************************* */
+/* Recursive function that searches an item with key 'v'     */
+/* after 't' (taking into account that the list is in the    */
+/* order of the keys) at level 'k'. The recursion proceeds   */
+/* as follows: it moves to the next node in the list on      */
+/* level 'k' if its key is smaller than the search key 'v'   */
+/* or down to level 'k-1' if its key is not smaller.         */
+static Item searchR (List l, link t, Key v, int k)
+{
+   if (t->next[k] == NULL) { /* end of the list of level 'k' */
+      if (k == 0) /* not found */
+	 return NULLitem;
+      return searchR (l, t, v, k-1); /* down to level 'k-1' */
+   }
+   if (eq (v, key (t->next[k]->item))) { /* it was found */
+      t->next[k]->cont++; /* increments the item counter */
+      /* Checks if the item counter exceeded the actual maxItem. */
+      if (l->maxItem->cont < t->next[k]->cont)
+      	 l->maxItem = t->next[k];
+      return t->next[k]->item;
+   }
+   if (less (v, key (t->next[k]->item))) { /* 'v' is smaller */
+      if (k == 0) /* not found */
+	 return NULLitem;
+      return searchR (l, t, v, k-1); /* down to level 'k-1' */
+   }
+   return searchR (l, t->next[k], v, k); /* searches from the next item */
+
+} /* searchR */
+
+
+/* ********************************************************* */
+/* Searches an item with a given key 'v' (envelope function  */
+/* to be exported).                                          */
+static Item LISTsearch (void *p, Key v)
+{
+   List l = p;
+
+   /* The search begins from the 'head' and */
+   /* at the actual highest level 'lgN'.    */
+   return searchR (l, l->head, v, l->lgN);
+
+} /* LISTsearch */
+
+
+/* ********************************************************* */
+/* Recursive function that returns the node with key 'v'     */
+/* after 't' at level 'k' (as 'searchR', but without         */
+/* changing its counter), or NULL if there is no such node.  */
+static link findR (link t, Key v, int k)
+{
+   while (t->next[k] != NULL && less (key (t->next[k]->item), v))
+      t = t->next[k]; /* 'v' is greater */
+   if (t->next[k] != NULL && eq (v, key (t->next[k]->item)))
+      return t->next[k]; /* it was found */
+   if (k == 0) /* not found */
+      return NULL;
+   return findR (t, v, k-1); /* down to level 'k-1' */
+
+} /* findR */
+
+
+/* ********************************************************* */
+/* Adds 'n' to the counter of the item with the key of       */
+/* 'item', inserting a copy of it if it is not in the list,  */
+/* and returns its node (envelope function to be exported).  */
+static void *LISTadd (void *p, Item item, unsigned long n)
+{
+   List l = p;
+   link x;
+
+   x = findR (l->head, key (item), l->lgN);
+   if (x == NULL) { /* new item with counter 'n' */
+      x = NEW (l, ITEMdup (l->arena, item), randX (l));
+      insertR (l->head, x, l->lgN);
+      l->N++; /* one more item in the list */
+      x->cont = n;
+   }
+   else
+      x->cont += n;
+
+   /* Checks if the item counter exceeded the actual maxItem. */
+   if (l->maxItem->cont < x->cont)
+      l->maxItem = x;
+
+   return x;
+
+} /* LISTadd */
+
+
+/* ********************************************************* */
+/* Returns the item of the node 'r'.                         */
+static Item LISTrefItem (void *r)
+{
+   return ((link) r)->item;
+
+} /* LISTrefItem */
+
+
+/* ********************************************************* */
+/* Adds 'n' to the counter of the node 'r' of the list 'p'.  */
+static void LISTrefAdd (void *p, void *r, unsigned long n)
+{
+   List l = p;
+   link x = r;
+
+   x->cont += n;
+   /* Checks if the item counter exceeded the actual maxItem. */
+   if (l->maxItem->cont < x->cont)
+      l->maxItem = x;
+
+} /* LISTrefAdd */
+
+
+/* ********************************************************* */
+/* Returns a pointer to the highest score element of the     */
+/* list.                                                     */
+/* Obs.: it is only to be used to correct the 'maxItem'      */
+/* pointer (which may occur, for example, at 'deleteR'       */
+/* function).                                                */
+static link searchMaxItem (List l)
+{
+   link newMax, t;
+
+   t = l->head;
+   if (t->next[0] == NULL) /* empty list */
+      return NULLitem;
+
+   newMax = t->next[0];
+   t = t->next[0];
+   while (t->next[0] != NULL) { /* scans the list */
+      t = t->next[0];
+      if (t->cont > newMax->cont)
+	 newMax = t;
+   }
+
+   return newMax;
+
+} /* searchMaxItem */
+
+/* ********************************************************* */
+/* Recursive function that removes the item with key 'v'. It */
+/* proceeds quite similar to the 'searchR' function. If the  */
+/* item found has a counter greater than 1 this function     */
+/* only decrements its counter, otherwise it is necessary to */
+/* unlink it at each level that we find a link to it. The    */
+/* node itself stays in the arena until the list is freed.   */
+/* If the item is the highest score item, the 'maxItem'      */
+/* pointer have to be fixed by calling 'searchMaxItem'.      */
+static void deleteR (List l, link t, Key v, int k)
+{
+   link x = t->next[k];
+   if (t->next[k] == NULL) { /* end of the list of level 'k' */
+      if (k > 0)
+	 deleteR(l, t, v, k-1); /* down to level 'k-1' */
+   }
+   else if (eq (v, key (t->next[k]->item))) {
+      if (t->next[k]->cont > 1) { /* only decrements the item's counter */
+	 t->next[k]->cont--;
+	 if (l->maxItem == t->next[k])
+	    l->maxItem = searchMaxItem (l); /* fixes maxItem pointer */
+	 return;
+      }
+      t->next[k] = x->next[k]; /* unlink at level k */
+      if (k == 0) { /* reached the bottom level */
+	 l->N--; /* one less item in the list */
+	 if (l->maxItem == x)
+	    l->maxItem = searchMaxItem (l); /* fixes maxItem pointer */
+	 return;
+      }
+      deleteR (l, t, v, k-1); /* down to level 'k-1' */
+   }
+   else if (less (v, key (t->next[k]->item))) { /* 'v' is smaller */
+      if (k > 0)
+	 deleteR (l, t, v, k-1); /* down to level 'k-1' */
+   }
+   else deleteR (l, t->next[k], v, k); /* 'v' is greater */
+
+} /* deleteR */
+
+
+/* ********************************************************* */
+/* Removes an item with key 'v' (envelope function to be     */
+/* exported).                                                */
+static void LISTdelete (void *p, Key v)
+{
+   List l = p;
+
+   /* It starts looking for the item to be deleted from */
+   /* the 'head' and at the actual highest level 'lgN'. */
+   deleteR (l, l->head, v, l->lgN);
+
+} /* LISTdelete */
+
+
+/* ********************************************************* */
+/* Compares two items by their keys (used by 'qsort').       */
+static int compItem (const void *a, const void *b)
+{
+   return ITEMkeyCompare (*(Item *) a, *(Item *) b);
+
+} /* compItem */
+
+
+/* ********************************************************* */
+/* Returns a vector with the 'N' items of the list 'l'       */
+/* sorted by their keys (the list itself is ordered by the   */
+/* hashes of the items).                                     */
+static Item *sortItems (List l)
+{
+   int n = 0;
+   link t = l->head;
+   Item *v;
+
+   v = UTILmalloc ((l->N + 1) * sizeof (Item));
+   while (t->next[0] != NULL) {
+      t = t->next[0];
+      v[n++] = t->item;
+   }
+   qsort (v, n, sizeof (Item), compItem);
+
+   return v;
+
+} /* sortItems */
+
+
+/* ********************************************************* */
+/* Returns the 'k'-th smallest item or returns 'NULLitem' if */
+/* the list is has less then 'k' items.                      */
+static Item LISTselect (void *p, int k)
+{
+   Item item, *v;
+
+   /* If there is less than 'k' items in the list. */
+   if (k < 1 || k > ((List) p)->N)
+      return NULLitem;
+
+   v = sortItems (p);
+   item = v[k-1];
+   free (v);
+
+   return item;
+
+} /* LISTselect */
+
+
+/* ********************************************************* */
+/* Visit the items in the order of their keys (calling a     */
+/* procedure passed as an argument for each item).           */
+static void LISTsort (void *p, FILE *std, void (*visit)(FILE *std, Item))
+{
+   int i;
+   Item *v;
+
+   v = sortItems (p);
+   for (i = 0; i < ((List) p)->N; i++)
+      visit(std, v[i]); /* call the procedure */
+   free (v);
+
+} /* LISTsort */
+
+
+/* ********************************************************* */
+/* Visit the items in the order of their keys (calling a     */
+/* procedure passed as an argument with each item, its       */
+/* counter and 'arg').                                       */
+static void LISTwalk (void *p, void (*visit)(Item, unsigned long, void *),
+		      void *arg)
+{
+   link t = ((List) p)->head;
+
+   while (t->next[0] != NULL) {
+      t = t->next[0];
+      visit (t->item, t->cont, arg); /* call the procedure */
+   }
+
+} /* LISTwalk */
+
+
+/* ********************************************************* */
+/* Return the quantity of different items.                   */
+static int LISTcount (void *p)
+{
+   return ((List) p)->N;
+
+} /* LISTcount */
+
+
+/* ********************************************************* */
+/* Returns the key of the highest score item.                */
+static Key LISTmaxItem (void *p)
+{
+   return (key(((List) p)->maxItem->item));
+
+} /* LISTmaxItem */
+
+
+/* ********************************************************* */
+/* Returns the score of the highest score item.              */
+static unsigned long LISTmaxCont (void *p)
+{
+   return ((List) p)->maxItem->cont;
+
+} /* LISTmaxCont */
+
+
+/* ********************************************************* */
+/* Returns the maximum overestimation of the scores (they    */
+/* are exact).                                               */
+static unsigned long LISTerrBound (void *p)
+{
+   return 0;
+
+} /* LISTerrBound */
+
+
+/* ********************************************************* */
+/* Returns the sum of the scores of all items.               */
+static unsigned long LISTtotalCount (void *p)
+{
+   unsigned long count = 0;
+   link t = ((List) p)->head;
+
+   while (t->next[0] != NULL) {
+      t = t->next[0];
+      count += t->cont;
+   }
+
+   return count;
+
+} /* LISTtotalCount */
+
+
+/* ********************************************************* */
+/* Frees memory of all nodes (destroys the symbol-table). As */
+/* the nodes, their links and items (and the head) were all  */
+/* taken from the arena, it is enough to free its slabs.     */
+static void LISTfree (void *p)
+{
+   UTILarenaFree (((List) p)->arena);
+   free (p);
+
+} /* LISTfree */
+
+
+/* Operations of the skip list symbol-table (see STimpl.h). */
+STops STlistOps = { LISTinit, LISTinsert, LISTsearch, LISTadd, LISTrefItem,
+		    LISTrefAdd, LISTdelete, LISTselect, LISTsort, LISTwalk,
+		    LISTcount, LISTmaxItem, LISTmaxCont, LISTerrBound,
+		    LISTtotalCount, LISTfree };
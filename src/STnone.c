@@ -0,0 +1,216 @@
+/**  *****************************************************  **/
+/**       ** Finding the Most Representative Graph **       **/
+/**       **    Model for Neuronal Interactions    **       **/
+/**       **     via Markov Chain Monte Carlo      **       **/
+/**                                                         **/
+/**   Author: Pedro Brandimarte Mendonca                    **/
+/**                                                         **/
+/**  *****************************************************  **/
+/**  This code is based on R. Sedgewick "Algorithms in C    **/
+/**  Parts 1-4", 3rd Edition, Addison-Wesley (1998).        **/
+/**  *****************************************************  **/
+/**  Abstract data type implementation for a disabled       **/
+/**  symbol-table, used when the histogram of the items is  **/
+/**  not needed. It only keeps a copy of the last item      **/
+/**  added (so that the users of 'STaddRef' still have a    **/
+/**  stored copy of the current item) and the sum of all    **/
+/**  the scores, which are credited to this single item.    **/
+/**  Thus it takes constant memory and time, 'STcount' and  **/
+/**  'STmaxCont' return 0 and 'STmaxItem' is the last item. **/
+/**  The operations are exported through 'STnoneOps' (see   **/
+/**  STimpl.h) and chosen at 'STinit' with 'STnone'.        **/
+/**  *****************************************************  **/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include "Utils.h"
+#include "Item.h"
+#include "STimpl.h"
+
+/* The table has the copy 'item' of the last item added (or   */
+/* NULLitem) and the sum 'total' of all the scores.           */
+typedef struct NONEtable *None;
+struct NONEtable { Item item; unsigned long total; };
+
+
+/* ********************************************************* */
+/* Creates an empty table ('max' is not used).               */
+static void *NONEinit (int max)
+{
+   None t;
+
+   t = UTILmalloc (sizeof *t);
+   t->item = NULLitem;
+   t->total = 0;
+
+   return t;
+
+} /* NONEinit */
+
+
+/* ********************************************************* */
+/* Keeps a copy of 'item' as the last item, adds 'n' to the  */
+/* total and returns the table itself (the reference of its  */
+/* single item).                                             */
+static void *NONEadd (void *p, Item item, unsigned long n)
+{
+   None t = p;
+
+   if (t->item == NULLitem)
+      t->item = ITEMnew ();
+   copy (t->item, item);
+   t->total += n;
+
+   return t;
+
+} /* NONEadd */
+
+
+/* ********************************************************* */
+/* Keeps a copy of 'item' (with score 1) and returns it.     */
+static Item NONEinsert (void *p, Item item)
+{
+   return ((None) NONEadd (p, item, 1))->item;
+
+} /* NONEinsert */
+
+
+/* ********************************************************* */
+/* Searches an item with a given key 'v': only the last item */
+/* can be found (and then the total is incremented).         */
+static Item NONEsearch (void *p, Key v)
+{
+   None t = p;
+
+   if (t->item == NULLitem || !eq (v, key (t->item)))
+      return NULLitem;
+   t->total++;
+
+   return t->item;
+
+} /* NONEsearch */
+
+
+/* ********************************************************* */
+/* Returns the item of the reference 'r' (the table).        */
+static Item NONErefItem (void *r)
+{
+   return ((None) r)->item;
+
+} /* NONErefItem */
+
+
+/* ********************************************************* */
+/* Adds 'n' to the total of the table 'p'.                   */
+static void NONErefAdd (void *p, void *r, unsigned long n)
+{
+   ((None) p)->total += n;
+
+} /* NONErefAdd */
+
+
+/* ********************************************************* */
+/* Removes an item (only decrements the total, if it is the  */
+/* last item).                                               */
+static void NONEdelete (void *p, Key v)
+{
+   None t = p;
+
+   if (t->item != NULLitem && eq (v, key (t->item)) && t->total > 0)
+      t->total--;
+
+} /* NONEdelete */
+
+
+/* ********************************************************* */
+/* There is no histogram, so there is no 'k'-th item.        */
+static Item NONEselect (void *p, int k)
+{
+   return NULLitem;
+
+} /* NONEselect */
+
+
+/* ********************************************************* */
+/* There is no histogram, so no item is visited.             */
+static void NONEsort (void *p, FILE *std, void (*visit)(FILE *std, Item))
+{
+
+} /* NONEsort */
+
+
+/* ********************************************************* */
+/* Visits the last item with the total (so that merging the  */
+/* tables with 'STadd' sums their totals).                   */
+static void NONEwalk (void *p, void (*visit)(Item, unsigned long, void *),
+		      void *arg)
+{
+   None t = p;
+
+   if (t->item != NULLitem)
+      visit (t->item, t->total, arg);
+
+} /* NONEwalk */
+
+
+/* ********************************************************* */
+/* There is no histogram, so there are no distinct items.    */
+static int NONEcount (void *p)
+{
+   return 0;
+
+} /* NONEcount */
+
+
+/* ********************************************************* */
+/* Returns the key of the last item.                         */
+static Key NONEmaxItem (void *p)
+{
+   return key (((None) p)->item);
+
+} /* NONEmaxItem */
+
+
+/* ********************************************************* */
+/* There is no histogram, so there is no score of an item.   */
+static unsigned long NONEmaxCont (void *p)
+{
+   return 0;
+
+} /* NONEmaxCont */
+
+
+/* ********************************************************* */
+/* No score is kept, so none is overestimated.               */
+static unsigned long NONEerrBound (void *p)
+{
+   return 0;
+
+} /* NONEerrBound */
+
+
+/* ********************************************************* */
+/* Returns the sum of the scores of all items.               */
+static unsigned long NONEtotalCount (void *p)
+{
+   return ((None) p)->total;
+
+} /* NONEtotalCount */
+
+
+/* ********************************************************* */
+/* Frees memory (destroys the symbol-table).                 */
+static void NONEfree (void *p)
+{
+   if (((None) p)->item != NULLitem)
+      ITEMfree (((None) p)->item);
+   free (p);
+
+} /* NONEfree */
+
+
+/* Operations of the disabled symbol-table (see STimpl.h). */
+STops STnoneOps = { NONEinit, NONEinsert, NONEsearch, NONEadd, NONErefItem,
+		    NONErefAdd, NONEdelete, NONEselect, NONEsort, NONEwalk,
+		    NONEcount, NONEmaxItem, NONEmaxCont, NONEerrBound,
+		    NONEtotalCount, NONEfree };
@@ -0,0 +1,510 @@
+/**  *****************************************************  **/
+/**       ** Finding the Most Representative Graph **       **/
+/**       **    Model for Neuronal Interactions    **       **/
+/**       **     via Markov Chain Monte Carlo      **       **/
+/**                                                         **/
+/**   Author: Pedro Brandimarte Mendonca                    **/
+/**                                                         **/
+/**  *****************************************************  **/
+/**  This code is based on R. Sedgewick "Algorithms in C    **/
+/**  Parts 1-4", 3rd Edition, Addison-Wesley (1998).        **/
+/**  *****************************************************  **/
+/**  Abstract data type implementation for a bounded        **/
+/**  symbol-table that keeps at most 'K' items with the     **/
+/**  "Space-Saving" algorithm (A. Metwally, D. Agrawal and  **/
+/**  A. El Abbadi, "Efficient computation of frequent and   **/
+/**  top-k elements in data streams", ICDT 2005).           **/
+/**  While there is room, the counters are exact. When a    **/
+/**  new item arrives at a full table, the item with the    **/
+/**  smallest counter 'min' is evicted and the new item     **/
+/**  takes its entry with counter 'min + n'. Thus the sum   **/
+/**  of the counters is always the exact total, no counter  **/
+/**  is underestimated and each counter is overestimated by **/
+/**  at most the smallest counter (see 'STerrBound'), which **/
+/**  is at most 'total / K'. Any item whose true counter is **/
+/**  greater than the smallest one is in the table, so the  **/
+/**  most frequent item is found whenever it is frequent    **/
+/**  enough, with a memory that does not depend on the      **/
+/**  number of steps.                                       **/
+/**  The entries are found by a table of slots with open    **/
+/**  addressing (as in SThash.c) and are kept in a binary   **/
+/**  min-heap ordered by their counters, so that the        **/
+/**  smallest counter is at the root.                       **/
+/**  The operations are exported through 'STtopkOps' (see   **/
+/**  STimpl.h) and chosen at 'STinit' with 'STtopk'.        **/
+/**  *****************************************************  **/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "Utils.h"
+#include "Item.h"
+#include "STimpl.h"
+
+#define SLAB 1048576 /* bytes of each slab of the arena */
+
+/* Each entry has an item, its counter 'cont' (which exceeds  */
+/* the true counter by at most 'err') and its position 'pos'  */
+/* in the heap.                                               */
+typedef struct TOPKentry *link;
+struct TOPKentry { Item item; unsigned long cont, err; int pos; };
+
+/* Each table has 'K' entries: 'heap[0..N-1]' are the entries */
+/* in use (a min-heap by their counters) and 'heap[N..K-1]'   */
+/* are the free ones. The 'M' slots (a power of 2 at least    */
+/* '2K') point to the entries in use (or are NULL).           */
+typedef struct TOPKtable *Topk;
+struct TOPKtable {
+   link *slot; /* table of slots */
+   link *heap; /* heap of entries */
+   link entries; /* memory of the entries */
+   Arena arena; /* memory of the items */
+   unsigned long M; /* number of slots */
+   int K; /* maximum number of items */
+   int N; /* number of items in the table */
+   unsigned long total; /* sum of the counters of all items */
+   link maxItem; /* element with higher frequency */
+};
+
+
+/* ********************************************************* */
+/* Creates a table with room for 'max' items (at least 1).   */
+static void *TOPKinit (int max)
+{
+   int i;
+   Topk t;
+
+   t = UTILmalloc (sizeof *t);
+   t->K = (max > 0) ? max : 1;
+   for (t->M = 2; t->M < 2 * (unsigned long) t->K; t->M *= 2)
+      ;
+   t->slot = UTILmalloc (t->M * sizeof (link));
+   t->heap = UTILmalloc (t->K * sizeof (link));
+   t->entries = UTILmalloc (t->K * sizeof (struct TOPKentry));
+   t->arena = UTILarenaInit (SLAB);
+   for (i = 0; i < (int) t->M; i++)
+      t->slot[i] = NULL;
+   for (i = 0; i < t->K; i++) {
+      t->heap[i] = &t->entries[i];
+      t->heap[i]->item = NULLitem; /* taken from the arena when used */
+      t->heap[i]->pos = i;
+   }
+   t->N = 0;
+   t->total = 0;
+   t->maxItem = NULL;
+
+   return t;
+
+} /* TOPKinit */
+
+
+/* ********************************************************* */
+/* Returns the index of the slot of the table 't' that holds */
+/* the item with key 'v', or the index of the empty slot     */
+/* where it should be inserted.                              */
+static unsigned long probe (Topk t, Key v)
+{
+   unsigned long i;
+
+   for (i = ITEMhash (v) & (t->M - 1); t->slot[i] != NULL;
+	i = (i + 1) & (t->M - 1))
+      if (eq (v, key (t->slot[i]->item)))
+	 break;
+
+   return i;
+
+} /* probe */
+
+
+/* ********************************************************* */
+/* Empties the slot 'i' and fills the hole by shifting back  */
+/* the following entries of the same cluster (as in          */
+/* 'HASHdelete' at SThash.c).                                */
+static void unslot (Topk t, unsigned long i)
+{
+   unsigned long j, k, M = t->M;
+   link *st = t->slot;
+
+   st[i] = NULL;
+   for (j = (i + 1) & (M - 1); st[j] != NULL; j = (j + 1) & (M - 1)) {
+      k = ITEMhash (key (st[j]->item)) & (M - 1); /* home slot */
+      /* Moves it if 'i' is cyclically in [k, j). */
+      if ((j > i && (k <= i || k > j)) || (j < i && k <= i && k > j)) {
+	 st[i] = st[j];
+	 st[j] = NULL;
+	 i = j;
+      }
+   }
+
+} /* unslot */
+
+
+/* ********************************************************* */
+/* Puts the entry 'x' at the position 'i' of the heap.       */
+static void place (Topk t, link x, int i)
+{
+   t->heap[i] = x;
+   x->pos = i;
+
+} /* place */
+
+
+/* ********************************************************* */
+/* Moves the entry at the position 'i' of the heap up, while */
+/* its counter is smaller than the counter of its parent.    */
+static void fixUp (Topk t, int i)
+{
+   link x = t->heap[i];
+
+   while (i > 0 && x->cont < t->heap[(i-1)/2]->cont) {
+      place (t, t->heap[(i-1)/2], i);
+      i = (i - 1) / 2;
+   }
+   place (t, x, i);
+
+} /* fixUp */
+
+
+/* ********************************************************* */
+/* Moves the entry at the position 'i' of the heap down,     */
+/* while its counter is greater than the counter of one of   */
+/* its children (used when a counter is incremented).        */
+static void fixDown (Topk t, int i)
+{
+   int j;
+   link x = t->heap[i];
+
+   while ((j = 2 * i + 1) < t->N) {
+      if (j + 1 < t->N && t->heap[j+1]->cont < t->heap[j]->cont)
+	 j++; /* smaller child */
+      if (x->cont <= t->heap[j]->cont)
+	 break;
+      place (t, t->heap[j], i);
+      i = j;
+   }
+   place (t, x, i);
+
+} /* fixDown */
+
+
+/* ********************************************************* */
+/* Adds 'n' to the counter of the entry 'x' of the table 't' */
+/* (updating its heap position and 'maxItem').               */
+static void increment (Topk t, link x, unsigned long n)
+{
+   x->cont += n;
+   t->total += n;
+   fixDown (t, x->pos);
+
+   /* Checks if the item counter exceeded the actual maxItem. */
+   if (t->maxItem->cont < x->cont)
+      t->maxItem = x;
+
+} /* increment */
+
+
+/* ********************************************************* */
+/* Adds 'n' to the counter of the item with the key of       */
+/* 'item' and returns its entry. If the item is not in the   */
+/* table, it takes a free entry with counter 'n' or, if the  */
+/* table is full, the entry of the item with the smallest    */
+/* counter 'min', which is evicted, with counter 'min + n'.  */
+static void *TOPKadd (void *p, Item item, unsigned long n)
+{
+   unsigned long i;
+   Topk t = p;
+   link x;
+
+   i = probe (t, key (item));
+   if ((x = t->slot[i]) != NULL) { /* it was found */
+      increment (t, x, n);
+      return x;
+   }
+
+   if (t->N < t->K) { /* takes a free entry */
+      x = t->heap[t->N];
+      if (x->item == NULLitem)
+	 x->item = ITEMdup (t->arena, item);
+      else
+	 copy (x->item, item);
+      x->cont = x->err = 0;
+      t->slot[i] = x;
+      t->N++; /* one more item in the table */
+      fixUp (t, x->pos);
+      if (t->maxItem == NULL)
+	 t->maxItem = x;
+   }
+   else { /* evicts the item with the smallest counter */
+      x = t->heap[0];
+      unslot (t, probe (t, key (x->item)));
+      copy (x->item, item);
+      x->err = x->cont; /* the new counter starts at 'min' */
+      t->slot[probe (t, key (item))] = x;
+      if (t->maxItem == x)
+	 t->maxItem = t->heap[t->N-1]; /* all counters are equal */
+   }
+   increment (t, x, n);
+
+   return x;
+
+} /* TOPKadd */
+
+
+/* ********************************************************* */
+/* Adds a copy of a new item (with counter 1) and returns    */
+/* the copy.                                                 */
+static Item TOPKinsert (void *p, Item item)
+{
+   return ((link) TOPKadd (p, item, 1))->item;
+
+} /* TOPKinsert */
+
+
+/* ********************************************************* */
+/* Searches an item with a given key 'v'. If it is found its */
+/* counter is incremented (and 'maxItem' is updated if       */
+/* necessary), otherwise returns 'NULLitem'.                 */
+static Item TOPKsearch (void *p, Key v)
+{
+   Topk t = p;
+   link x;
+
+   if ((x = t->slot[probe (t, v)]) == NULL) /* not found */
+      return NULLitem;
+
+   increment (t, x, 1);
+
+   return x->item;
+
+} /* TOPKsearch */
+
+
+/* ********************************************************* */
+/* Returns the item of the entry 'r'.                        */
+static Item TOPKrefItem (void *r)
+{
+   return ((link) r)->item;
+
+} /* TOPKrefItem */
+
+
+/* ********************************************************* */
+/* Adds 'n' to the counter of the entry 'r' of the table     */
+/* 'p' (the entry must not have been evicted).               */
+static void TOPKrefAdd (void *p, void *r, unsigned long n)
+{
+   increment (p, r, n);
+
+} /* TOPKrefAdd */
+
+
+/* ********************************************************* */
+/* Returns a pointer to the highest score entry of the table */
+/* 't' (only used to correct 'maxItem' after a removal).     */
+static link searchMaxItem (Topk t)
+{
+   int i;
+   link newMax = NULL;
+
+   for (i = 0; i < t->N; i++)
+      if (newMax == NULL || t->heap[i]->cont > newMax->cont)
+	 newMax = t->heap[i];
+
+   return newMax;
+
+} /* searchMaxItem */
+
+
+/* ********************************************************* */
+/* Removes the item with key 'v'. If its counter is greater  */
+/* than 1 only decrements the counter, otherwise it frees    */
+/* its slot and its entry (the last entry of the heap takes  */
+/* its position).                                            */
+static void TOPKdelete (void *p, Key v)
+{
+   int i;
+   unsigned long s;
+   Topk t = p;
+   link x, last;
+
+   s = probe (t, v);
+   if ((x = t->slot[s]) == NULL) /* not found */
+      return;
+
+   t->total--;
+   if (x->cont > 1) { /* only decrements the item's counter */
+      x->cont--;
+      if (x->err > x->cont)
+	 x->err = x->cont;
+      fixUp (t, x->pos);
+   }
+   else {
+      unslot (t, s);
+      i = x->pos;
+      t->N--; /* one less item in the table */
+      last = t->heap[t->N];
+      place (t, x, t->N); /* a free entry */
+      if (i < t->N) {
+	 place (t, last, i);
+	 fixUp (t, i);
+	 fixDown (t, last->pos);
+      }
+   }
+
+   if (t->maxItem == x)
+      t->maxItem = searchMaxItem (t); /* fixes maxItem pointer */
+
+} /* TOPKdelete */
+
+
+/* ********************************************************* */
+/* Compares two entries by the keys of their items (used by  */
+/* 'qsort').                                                 */
+static int compEntry (const void *a, const void *b)
+{
+   return ITEMkeyCompare (key ((*(link *) a)->item), key ((*(link *) b)->item));
+
+} /* compEntry */
+
+
+/* ********************************************************* */
+/* Returns a vector with the 'N' entries of the table 't'    */
+/* sorted by the keys of their items.                        */
+static link *sortEntries (Topk t)
+{
+   link *v;
+
+   v = UTILmalloc ((t->N + 1) * sizeof (link));
+   memcpy (v, t->heap, t->N * sizeof (link));
+   qsort (v, t->N, sizeof (link), compEntry);
+
+   return v;
+
+} /* sortEntries */
+
+
+/* ********************************************************* */
+/* Returns the 'k'-th smallest item or returns 'NULLitem' if */
+/* the table has less then 'k' items.                        */
+static Item TOPKselect (void *p, int k)
+{
+   Item item;
+   link *v;
+
+   if (k < 1 || k > ((Topk) p)->N)
+      return NULLitem;
+
+   v = sortEntries (p);
+   item = v[k-1]->item;
+   free (v);
+
+   return item;
+
+} /* TOPKselect */
+
+
+/* ********************************************************* */
+/* Visit the items in the order of their keys (calling a     */
+/* procedure passed as an argument for each item).           */
+static void TOPKsort (void *p, FILE *std, void (*visit)(FILE *std, Item))
+{
+   int i;
+   link *v;
+
+   v = sortEntries (p);
+   for (i = 0; i < ((Topk) p)->N; i++)
+      visit (std, v[i]->item); /* call the procedure */
+   free (v);
+
+} /* TOPKsort */
+
+
+/* ********************************************************* */
+/* Visit the items in the order of the heap (calling a       */
+/* procedure passed as an argument with each item, its       */
+/* counter and 'arg').                                       */
+static void TOPKwalk (void *p, void (*visit)(Item, unsigned long, void *),
+		      void *arg)
+{
+   int i;
+   Topk t = p;
+
+   for (i = 0; i < t->N; i++)
+      visit (t->heap[i]->item, t->heap[i]->cont, arg);
+
+} /* TOPKwalk */
+
+
+/* ********************************************************* */
+/* Return the quantity of different items in the table.      */
+static int TOPKcount (void *p)
+{
+   return ((Topk) p)->N;
+
+} /* TOPKcount */
+
+
+/* ********************************************************* */
+/* Returns the key of the highest score item.                */
+static Key TOPKmaxItem (void *p)
+{
+   return (key(((Topk) p)->maxItem->item));
+
+} /* TOPKmaxItem */
+
+
+/* ********************************************************* */
+/* Returns the score of the highest score item.              */
+static unsigned long TOPKmaxCont (void *p)
+{
+   return ((Topk) p)->maxItem->cont;
+
+} /* TOPKmaxCont */
+
+
+/* ********************************************************* */
+/* Returns the maximum overestimation of the counters: 0     */
+/* while the table is not full or the smallest counter       */
+/* otherwise.                                                */
+static unsigned long TOPKerrBound (void *p)
+{
+   Topk t = p;
+
+   if (t->N < t->K)
+      return 0;
+
+   return t->heap[0]->cont;
+
+} /* TOPKerrBound */
+
+
+/* ********************************************************* */
+/* Returns the sum of the scores of all items.               */
+static unsigned long TOPKtotalCount (void *p)
+{
+   return ((Topk) p)->total;
+
+} /* TOPKtotalCount */
+
+
+/* ********************************************************* */
+/* Frees memory of all entries (destroys the symbol-table).  */
+/* The items are freed with the arena.                       */
+static void TOPKfree (void *p)
+{
+   Topk t = p;
+
+   UTILarenaFree (t->arena);
+   free (t->entries);
+   free (t->heap);
+   free (t->slot);
+   free (t);
+
+} /* TOPKfree */
+
+
+/* Operations of the top-K symbol-table (see STimpl.h). */
+STops STtopkOps = { TOPKinit, TOPKinsert, TOPKsearch, TOPKadd, TOPKrefItem,
+		    TOPKrefAdd, TOPKdelete, TOPKselect, TOPKsort, TOPKwalk,
+		    TOPKcount, TOPKmaxItem, TOPKmaxCont, TOPKerrBound,
+		    TOPKtotalCount, TOPKfree };
@@ -8,13 +8,34 @@
 /**  *****************************************************  **/
 /**  Implementation of alternative versions of well known   **/
 /**  functions from 'stdio.h' and 'stdlib.h' to avoid code  **/
-/**  repetition.                                            **/
+/**  repetition, of arenas of memory and of the reading of  **/
+/**  text files mapped into memory.                         **/
 /**  *****************************************************  **/
 
 #include <stdio.h>
 #include <stdlib.h>
+#include <string.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
 #include "Utils.h"
 
+#define FASTdigits 15 /* digits exactly represented by a double */
+#define FASTexp 22 /* largest power of 10 exactly represented */
+#define NUMmax 512 /* longest number given to 'strtod' */
+
+/* Type with the strictest alignment of the blocks of memory. */
+typedef union { long l; double d; void *p; } align;
+
+/* Rounds 'n' up to a multiple of the size of 'align'. */
+#define roundUp(n) (((n) + sizeof (align) - 1) / sizeof (align) * sizeof (align))
+
+/* An arena is a list of slabs (the first bytes of each slab */
+/* point to the previous one). The blocks are taken from the */
+/* 'left' bytes at the end of the current slab 'slab'.       */
+struct UTILarena { char *slab; char *free; unsigned int left, size; };
+
 
 /* ********************************************************* */
 /* Allocates a block of bytes if there are enough memory.    */
@@ -53,6 +74,26 @@ void *UTILrealloc (void *ptr1, unsigned int nbytes)
 } /* UTILrealloc */
 
 
+/* ********************************************************* */
+/* Allocates a block of bytes whose address is a multiple of */
+/* 'align' (a power of 2 multiple of 'sizeof (void *)', e.g. */
+/* the size of a cache line) if there are enough memory.     */
+/* Otherwise returns an error message and exits the program. */
+/* The block is freed by 'free'.                             */
+void *UTILmemalign (unsigned int align, unsigned int nbytes)
+{
+   void *ptr;
+
+   if (posix_memalign (&ptr, align, nbytes) != 0) {
+      fprintf (stderr, "\n Insufficient memory.\n");
+      exit (EXIT_FAILURE);
+   }
+
+   return ptr;
+
+} /* UTILmemalign */
+
+
 /* ********************************************************* */
 /* Opens the file named 'filename' in order to execute an    */
 /* operation specified by 'mode' (operations of the 'fopen'  */
@@ -88,3 +129,223 @@ void UTILcheckFscan (int info, const char *filename)
 } /* UTILcheckFscan */
 
 
+/* ********************************************************* */
+/* Maps the file named 'filename' into memory (read only)    */
+/* and returns its address, with its size in bytes at        */
+/* 'size'. If there is an error, returns an error message    */
+/* and exits the program. An empty file is not mapped (the   */
+/* address returned is NULL and 'size' is 0).                */
+char *UTILmmap (const char *filename, long *size)
+{
+   int fd;
+   char *addr = NULL;
+   struct stat st;
+
+   fd = open (filename, O_RDONLY);
+   if (fd < 0 || fstat (fd, &st) != 0) {
+      fprintf (stderr, "\n Error: Unable to open the file '%s'!\n\n", filename);
+      exit (EXIT_FAILURE);
+   }
+
+   *size = (long) st.st_size;
+   if (*size > 0) {
+      addr = mmap (NULL, *size, PROT_READ, MAP_PRIVATE, fd, 0);
+      if (addr == MAP_FAILED) {
+	 fprintf (stderr, "\n Error: Unable to map the file '%s'!\n\n",
+		  filename);
+	 exit (EXIT_FAILURE);
+      }
+   }
+   close (fd); /* the mapping stays valid */
+
+   return addr;
+
+} /* UTILmmap */
+
+
+/* ********************************************************* */
+/* Unmaps the 'size' bytes at 'addr' mapped by 'UTILmmap'.   */
+void UTILmunmap (char *addr, long size)
+{
+   if (addr != NULL)
+      munmap (addr, size);
+
+} /* UTILmunmap */
+
+
+/* ********************************************************* */
+/* Returns '1' if 'c' is a white-space character (as for     */
+/* 'fscanf' in the "C" locale).                              */
+static int isSpace (char c)
+{
+   return (c == ' ' || c == '\n' || c == '\t' || c == '\r'
+	   || c == '\v' || c == '\f');
+
+} /* isSpace */
+
+
+/* ********************************************************* */
+/* Reads a decimal number (like '-12.5e-3') from the text    */
+/* that starts at '*s' and ends before 'end', skipping the   */
+/* white-spaces before it. Returns '1' and the number at 'x' */
+/* (and advances '*s' to the end of the number), or EOF if   */
+/* there are only white-spaces, or '0' if the text is not a  */
+/* number. The number is exactly the same 'double' given by  */
+/* 'fscanf' with "%lf": if the number has at most 15         */
+/* significant digits and its decimal exponent is at most 22 */
+/* (in absolute value), both its digits and the power of 10  */
+/* are exact doubles and a single multiplication (or         */
+/* division) gives the correctly rounded result (Clinger's   */
+/* fast path). Otherwise, the number is given to 'strtod'.   */
+int UTILparseDouble (const char **s, const char *end, double *x)
+{
+   static const double pow10[] = { 1e0, 1e1, 1e2, 1e3, 1e4, 1e5, 1e6, 1e7,
+				   1e8, 1e9, 1e10, 1e11, 1e12, 1e13, 1e14,
+				   1e15, 1e16, 1e17, 1e18, 1e19, 1e20, 1e21,
+				   1e22 };
+   const char *p = *s, *ini;
+   int neg = 0, digits = 0, nd = 0, exp = 0, e = 0, eneg = 0;
+   unsigned long m = 0; /* significant digits */
+   char buf[NUMmax + 1], *q;
+
+   /* Skips the white-spaces. */
+   while (p < end && isSpace (*p))
+      p++;
+   if (p == end)
+      return EOF;
+   ini = p;
+
+   /* Sign. */
+   if (*p == '-' || *p == '+')
+      neg = (*p++ == '-');
+
+   /* Integer and fractional digits. */
+   for (; p < end && *p >= '0' && *p <= '9'; p++, digits++)
+      if (m != 0 || *p != '0') {
+	 if (nd++ < FASTdigits)
+	    m = 10 * m + (*p - '0');
+	 else
+	    exp++; /* digit lost (fast path not used) */
+      }
+   if (p < end && *p == '.') {
+      for (p++; p < end && *p >= '0' && *p <= '9'; p++, digits++) {
+	 if (m != 0 || *p != '0') {
+	    if (nd++ < FASTdigits) {
+	       m = 10 * m + (*p - '0');
+	       exp--;
+	    }
+	 }
+	 else
+	    exp--;
+      }
+   }
+
+   /* Exponent. */
+   if (digits > 0 && p < end && (*p == 'e' || *p == 'E')) {
+      q = (char *) p + 1;
+      if (q < end && (*q == '-' || *q == '+'))
+	 eneg = (*q++ == '-');
+      if (q < end && *q >= '0' && *q <= '9') {
+	 for (; q < end && *q >= '0' && *q <= '9'; q++)
+	    if (e < 10000)
+	       e = 10 * e + (*q - '0');
+	 p = q;
+	 exp += eneg ? -e : e;
+      }
+   }
+
+   if (digits > 0 && (p == end || isSpace (*p)) && nd <= FASTdigits
+       && (m == 0 || (exp >= -FASTexp && exp <= FASTexp))) {
+      /* Fast path. */
+      *x = (double) m;
+      if (m != 0 && exp < 0)
+	 *x /= pow10[-exp];
+      else if (m != 0)
+	 *x *= pow10[exp];
+      if (neg)
+	 *x = -*x;
+   }
+   else {
+      /* Slow path: 'strtod' with a copy of the word (as 'fscanf', */
+      /* it reads the longest prefix that is a number, which may  */
+      /* also be hexadecimal, an infinity or a NaN).              */
+      for (p = ini; p < end && !isSpace (*p) && p - ini < NUMmax; p++)
+	 buf[p - ini] = *p;
+      buf[p - ini] = '\0';
+      *x = strtod (buf, &q);
+      if (q == buf)
+	 return 0; /* not a number */
+      p = ini + (q - buf);
+   }
+
+   *s = p;
+
+   return 1;
+
+} /* UTILparseDouble */
+
+
+/* ********************************************************* */
+/* Creates an empty arena whose slabs will have 'slab' bytes */
+/* (a slab is only allocated when the first block is taken). */
+Arena UTILarenaInit (unsigned int slab)
+{
+   Arena a;
+
+   a = UTILmalloc (sizeof *a);
+   a->slab = NULL;
+   a->free = NULL;
+   a->left = 0;
+   a->size = roundUp (slab);
+
+   return a;
+
+} /* UTILarenaInit */
+
+
+/* ********************************************************* */
+/* Takes a block of 'nbytes' bytes (suitably aligned for any */
+/* type) from the arena 'a'. If the current slab has not     */
+/* enough bytes left, a new slab is allocated (with at least */
+/* 'nbytes' bytes) and the rest of the old one is wasted.    */
+void *UTILarenaAlloc (Arena a, unsigned int nbytes)
+{
+   char *s, *block;
+   unsigned int n;
+
+   nbytes = roundUp (nbytes);
+   if (nbytes > a->left) {
+      n = (nbytes > a->size) ? nbytes : a->size;
+      s = UTILmalloc (roundUp (sizeof (char *)) + n);
+      *(char **) s = a->slab; /* links to the previous slab */
+      a->slab = s;
+      a->free = s + roundUp (sizeof (char *));
+      a->left = n;
+   }
+
+   block = a->free;
+   a->free += nbytes;
+   a->left -= nbytes;
+
+   return block;
+
+} /* UTILarenaAlloc */
+
+
+/* ********************************************************* */
+/* Frees all the slabs of the arena 'a' (and thus all blocks */
+/* taken from it) and the arena itself. The cost depends     */
+/* only on the number of slabs, not on the number of blocks. */
+void UTILarenaFree (Arena a)
+{
+   char *s;
+
+   while (a->slab != NULL) {
+      s = a->slab;
+      a->slab = *(char **) s;
+      free (s);
+   }
+
+   free (a);
+
+} /* UTILarenaFree */
@@ -9,8 +9,15 @@
 /**  Interface for alternative versions of well known       **/
 /**  functions from 'stdio.h' and 'stdlib.h' to avoid code  **/
 /**  repetition.                                            **/
+/**  It also provides arenas of memory: blocks are taken    **/
+/**  from large contiguous slabs and are only released all  **/
+/**  together, when the arena is freed.                     **/
+/**  Text files can be mapped into memory and their numbers **/
+/**  parsed without 'fscanf' (see 'UTILparseDouble').       **/
 /**  *****************************************************  **/
 
+typedef struct UTILarena *Arena;
+
 /* Allocates a block of bytes if there are     */
 /* enough memory, otherwise exits the program. */
 void *UTILmalloc (unsigned int nbytes);
@@ -19,6 +26,10 @@ void *UTILmalloc (unsigned int nbytes);
 /* are enough memory or exits the program.      */
 void *UTILrealloc (void *ptr1, unsigned int nbytes);
 
+/* Allocates a block of bytes aligned at 'align' bytes */
+/* if there are enough memory or exits the program.    */
+void *UTILmemalign (unsigned int align, unsigned int nbytes);
+
 /* Opens the file named 'filename' in order to    */
 /* execute a 'mode' operation and verifies error. */
 FILE *UTILfopen (const char *filename, const char *mode);
@@ -27,3 +38,22 @@ FILE *UTILfopen (const char *filename, const char *mode);
 /* function to read data from the file named 'filename'. */
 void UTILcheckFscan (int info, const char *filename);
 
+/* Maps the file named 'filename' into memory (read only), */
+/* verifies error and returns its address and 'size'.      */
+char *UTILmmap (const char *filename, long *size);
+
+/* Unmaps a file mapped by 'UTILmmap'. */
+void UTILmunmap (char *addr, long size);
+
+/* Reads a decimal number from '*s' (up to 'end') into 'x'  */
+/* and returns like 'fscanf' (1, 0 or EOF), advancing '*s'. */
+int UTILparseDouble (const char **s, const char *end, double *x);
+
+/* Creates an arena whose slabs have 'slab' bytes. */
+Arena UTILarenaInit (unsigned int slab);
+
+/* Takes a block of bytes from the arena. */
+void *UTILarenaAlloc (Arena a, unsigned int nbytes);
+
+/* Frees all blocks of the arena (and the arena itself). */
+void UTILarenaFree (Arena a);
@@ -34,25 +34,50 @@
 
 #include <stdio.h>
 #include <stdlib.h>
+#include <string.h>
 #include "Neuro.h"
 
+/* Prints how to use the program and exits. */
+static void usage ()
+{
+   fprintf (stderr, "\n Use: ./bestGraph"); /* arg[0] */
+   fprintf (stderr, " [directory with data paths]"); /* arg[1] */
+   fprintf (stderr, " [directory for output files]"); /* arg[2] */
+   fprintf (stderr, " [available memory]"); /* arg[3] */
+   fprintf (stderr, " [fixed # of MC steps option: 0 or 1]"); /* arg[4] */
+   fprintf (stderr, " [brain region option]"); /* arg[5] */
+   fprintf (stderr, " [chosen mouse]"); /* arg[6] */
+   fprintf (stderr,
+	    " [method for probability computation (0,1,2)]"); /* arg[7] */
+   fprintf (stderr, " [penalty value]"); /* arg[8] */
+   fprintf (stderr, " [options]\n"); /* arg[9...] */
+   fprintf (stderr, "\n Options:");
+   fprintf (stderr, "\n   --st list|hash|none  symbol-table implementation");
+   fprintf (stderr, "\n   --topk K         keeps only the K most visited graphs");
+   fprintf (stderr, "\n   --marginals      marginal probabilities of the edges"
+	    " (no symbol-table)");
+   fprintf (stderr, "\n   --exact          exact posterior (no Monte Carlo)");
+   fprintf (stderr, "\n   --kernel metropolis|gibbs  one random edge or a scan"
+	    " of all edges per MC step");
+   fprintf (stderr, "\n   --chains K       independent chains (threads)");
+   fprintf (stderr, "\n   --tol T          stops when the MC error is below T"
+	    " standard deviations");
+   fprintf (stderr, "\n   --checkpoint S   saves the chains every S seconds");
+   fprintf (stderr, "\n   --resume         resumes the chains from their last"
+	    " checkpoint");
+   fprintf (stderr, "\n   --seed S         seed of the generators (default 1)\n\n");
+   exit (EXIT_FAILURE);
+
+} /* usage */
+
 int main (int nargs, char *arg[])
 {
+   int i;
 
    /* Checks if the input were typed correctly. */
-   if (nargs != 9) {
+   if (nargs < 9) {
       fprintf (stderr, "\n\n Wrong number of arguments!\n");
-      fprintf (stderr, "\n Use: ./bestGraph"); /* arg[0] */
-      fprintf (stderr, " [directory with data paths]"); /* arg[1] */
-      fprintf (stderr, " [directory for output files]"); /* arg[2] */
-      fprintf (stderr, " [available memory]"); /* arg[3] */
-      fprintf (stderr, " [fixed # of MC steps option: 0 or 1]"); /* arg[4] */
-      fprintf (stderr, " [brain region option]"); /* arg[5] */
-      fprintf (stderr, " [chosen mouse]"); /* arg[6] */
-      fprintf (stderr,
-	       " [method for probability computation (0,1,2)]"); /* arg[7] */
-      fprintf (stderr, " [penalty value]\n\n"); /* arg[8] */
-      exit (EXIT_FAILURE);
+      usage ();
    }
 
    /* Sets the available memory for graphs storage. */
@@ -73,10 +98,37 @@ int main (int nargs, char *arg[])
    /* Sets the penalty constant. */
    NEUROsetPenal (arg[8]);
 
+   /* Optional arguments. */
+   for (i = 9; i < nargs; i++) {
+      if (strcmp (arg[i], "--st") == 0 && i + 1 < nargs)
+	 NEUROsetST (arg[++i]); /* symbol-table implementation */
+      else if (strcmp (arg[i], "--topk") == 0 && i + 1 < nargs)
+	 NEUROsetTopK (arg[++i]); /* bounded symbol-table */
+      else if (strcmp (arg[i], "--marginals") == 0)
+	 NEUROsetMarginals (); /* marginal probabilities of the edges */
+      else if (strcmp (arg[i], "--exact") == 0)
+	 NEUROsetExact (); /* exact posterior */
+      else if (strcmp (arg[i], "--kernel") == 0 && i + 1 < nargs)
+	 NEUROsetKernel (arg[++i]); /* sampling kernel */
+      else if (strcmp (arg[i], "--chains") == 0 && i + 1 < nargs)
+	 NEUROsetChains (arg[++i]); /* number of independent chains */
+      else if (strcmp (arg[i], "--seed") == 0 && i + 1 < nargs)
+	 NEUROsetSeed (arg[++i]); /* seed of the generators */
+      else if (strcmp (arg[i], "--tol") == 0 && i + 1 < nargs)
+	 NEUROsetTol (arg[++i]); /* stop rule of the chains */
+      else if (strcmp (arg[i], "--checkpoint") == 0 && i + 1 < nargs)
+	 NEUROsetCheckpoint (arg[++i]); /* seconds between checkpoints */
+      else if (strcmp (arg[i], "--resume") == 0)
+	 NEUROsetResume (); /* resumes from the last checkpoint */
+      else {
+	 fprintf (stderr, "\n\n Wrong option '%s'!\n", arg[i]);
+	 usage ();
+      }
+   }
+
    /* Brain region specified by the user. */
    NEURObestGraph (arg[1], arg[2]);
 
    return 0;
    
 } /* main */
-
@@ -39,22 +39,56 @@
 
 #include <stdio.h>
 #include <stdlib.h>
+#include <string.h>
 #include "Neuro.h"
 
+/* Prints how to use the program and exits. */
+static void usage ()
+{
+   fprintf (stderr, "\n Use: ./graphPenalty"); /* arg[0] */
+   fprintf (stderr, " [directory with data paths]"); /* arg[1] */
+   fprintf (stderr, " [directory for output files]"); /* arg[2] */
+   fprintf (stderr, " [available memory]"); /* arg[3] */
+   fprintf (stderr, " [fixed # of MC steps option: 0 or 1]"); /* arg[4] */
+   fprintf (stderr, " [brain region option]"); /* arg[5] */
+   fprintf (stderr, " [chosen mouse]"); /* arg[6] */
+   fprintf (stderr, " [options]\n"); /* arg[7...] */
+   fprintf (stderr, "\n Options:");
+   fprintf (stderr, "\n   --st list|hash|none  symbol-table implementation");
+   fprintf (stderr, "\n   --topk K         keeps only the K most visited graphs");
+   fprintf (stderr, "\n   --marginals      marginal probabilities of the edges"
+	    " (no symbol-table)");
+   fprintf (stderr, "\n   --exact          exact posterior (no Monte Carlo)");
+   fprintf (stderr, "\n   --kernel metropolis|gibbs  one random edge or a scan"
+	    " of all edges per MC step");
+   fprintf (stderr, "\n   --chains K       independent chains (threads)");
+   fprintf (stderr, "\n   --tol T          stops when the MC error is below T"
+	    " standard deviations");
+   fprintf (stderr, "\n   --seed S         seed of the generators (default 1)");
+   fprintf (stderr, "\n   --threads T      penalty points computed at the same"
+	    " time (default: # of cores), which share the available memory");
+   fprintf (stderr, "\n   --sweep grid|pt|reweight|warm|adaptive  independent"
+	    " runs, replica exchange, reweighting from anchor penalties, runs"
+	    " started from the previous one or runs only where the results"
+	    " change");
+   fprintf (stderr, "\n   --anchors A      anchor penalties of the reweighting"
+	    " (default 16)");
+   fprintf (stderr, "\n   --stride S       penalty points between the first"
+	    " points of the adaptive sweep (default 16)");
+   fprintf (stderr, "\n   --refine T       refines where the log-posteriors"
+	    " differ by more than T (default 0)\n\n");
+   exit (EXIT_FAILURE);
+
+} /* usage */
+
 int main (int nargs, char *arg[])
 {
+   int i;
 
    /* Checks if the input were typed correctly. */
-   if (nargs != 7) {
+   if (nargs < 7) {
       fprintf (stderr, "\n\n Wrong number of arguments!\n");
-      fprintf (stderr, "\n Use: ./graphPenalty"); /* arg[0] */
-      fprintf (stderr, " [directory with data paths]"); /* arg[1] */
-      fprintf (stderr, " [directory for output files]"); /* arg[2] */
-      fprintf (stderr, " [available memory]"); /* arg[3] */
-      fprintf (stderr, " [fixed # of MC steps option: 0 or 1]"); /* arg[4] */
-      fprintf (stderr, " [brain region option]"); /* arg[5] */
-      fprintf (stderr, " [chosen mouse]\n\n"); /* arg[6] */
-      exit (EXIT_FAILURE);
+      usage ();
    }
 
    /* Sets available memory for graphs storage. */
@@ -69,10 +103,43 @@ int main (int nargs, char *arg[])
    /* Sets the mouse chosen for study. */
    NEUROsetMouse (arg[6]);
 
+   /* Optional arguments. */
+   for (i = 7; i < nargs; i++) {
+      if (strcmp (arg[i], "--st") == 0 && i + 1 < nargs)
+	 NEUROsetST (arg[++i]); /* symbol-table implementation */
+      else if (strcmp (arg[i], "--topk") == 0 && i + 1 < nargs)
+	 NEUROsetTopK (arg[++i]); /* bounded symbol-table */
+      else if (strcmp (arg[i], "--marginals") == 0)
+	 NEUROsetMarginals (); /* marginal probabilities of the edges */
+      else if (strcmp (arg[i], "--exact") == 0)
+	 NEUROsetExact (); /* exact posterior */
+      else if (strcmp (arg[i], "--kernel") == 0 && i + 1 < nargs)
+	 NEUROsetKernel (arg[++i]); /* sampling kernel */
+      else if (strcmp (arg[i], "--chains") == 0 && i + 1 < nargs)
+	 NEUROsetChains (arg[++i]); /* number of independent chains */
+      else if (strcmp (arg[i], "--seed") == 0 && i + 1 < nargs)
+	 NEUROsetSeed (arg[++i]); /* seed of the generators */
+      else if (strcmp (arg[i], "--tol") == 0 && i + 1 < nargs)
+	 NEUROsetTol (arg[++i]); /* stop rule of the chains */
+      else if (strcmp (arg[i], "--threads") == 0 && i + 1 < nargs)
+	 NEUROsetThreads (arg[++i]); /* threads of the penalty sweep */
+      else if (strcmp (arg[i], "--sweep") == 0 && i + 1 < nargs)
+	 NEUROsetSweep (arg[++i]); /* penalty sweep */
+      else if (strcmp (arg[i], "--anchors") == 0 && i + 1 < nargs)
+	 NEUROsetAnchors (arg[++i]); /* anchors of the reweighted sweep */
+      else if (strcmp (arg[i], "--stride") == 0 && i + 1 < nargs)
+	 NEUROsetStride (arg[++i]); /* coarse points of the adaptive sweep */
+      else if (strcmp (arg[i], "--refine") == 0 && i + 1 < nargs)
+	 NEUROsetRefine (arg[++i]); /* tolerance of the adaptive sweep */
+      else {
+	 fprintf (stderr, "\n\n Wrong option '%s'!\n", arg[i]);
+	 usage ();
+      }
+   }
+
    /* Brain region specified by the user. */
    NEUROpenalAnalysis (arg[1], arg[2]);
 
    return 0;
    
 } /* main */
-